@@ -48,6 +48,11 @@ layout(std430, binding = 3) buffer tileNormalsBuffer
     int tileNormals[];
 };
 layout(binding = 4) uniform atomic_uint maxValDiff;
+// Center of every hexagon, read back to the CPU for the hull calculation instead of the whole vertex buffer
+layout(std430, binding = 5) buffer hexCenterBuffer
+{
+    vec4 hexCenters[];
+};
 
 #include "/geometry-globals.glsl"
 
@@ -166,6 +171,8 @@ void main() {
 
     if (innerGroup) { // Hexagon triangles:
         vertices[triangleIndex] = centerPos;
+        if (gl_LocalInvocationID.x == 0)
+            hexCenters[hexID + (mirrorFlip ? POINT_COUNT : 0)] = centerPos;
     } else { // Neighbor triangles
         float neighborDepth;
         switch (geometryMode) {
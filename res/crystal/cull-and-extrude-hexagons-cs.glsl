@@ -2,7 +2,8 @@
 #extension GL_ARB_shading_language_include : required
 
 /**
- * Removes triangles outside convex hull and extrudes edges on convex hull boundaries
+ * Removes triangles outside the hull and extrudes edges on hull boundaries. The hull is either a convex polygon or,
+ * if concaveHull is set, a mask over the hexagons.
  */
 
 layout(local_size_x = 6, local_size_y = 1) in;
@@ -28,6 +29,7 @@ uniform int maxTexCoordY;
 uniform float tileNormalDisplacementFactor = 1.0;
 uniform int geometryMode = 0;
 uniform float cutValue = 0.5;
+uniform bool concaveHull = false;
 
 layout(std430, binding = 0) buffer vertexBuffer
 {
@@ -43,6 +45,11 @@ layout(std430, binding = 3) buffer tileNormalsBuffer
     int tileNormals[];
 };
 layout(binding = 4) uniform atomic_uint maxValDiff;
+// Concave hull: 1 for every hexagon inside of the hull
+layout(std430, binding = 5) buffer hullMaskBuffer
+{
+    uint hull_mask[];
+};
 
 #include "/geometry-globals.glsl"
 
@@ -77,6 +84,15 @@ bool isInsideHull(vec4 pos) {
     return true;
 }
 
+/// Checks whether a hexagon, in double height coordinates, is inside the concave hull
+bool isInsideHullMask(ivec2 hexCoord) {
+    const int row = hexCoord.y + hexCoord.x % 2;
+    if (row < 0)
+        return false;
+    const int id = row / 2 * num_cols + hexCoord.x;
+    return id < int(POINT_COUNT) && hull_mask[id] != 0u;
+}
+
 void main() {
     /// ------------------- Common for whole work group -------------------------------------------
     /*
@@ -110,7 +126,7 @@ void main() {
 
     const uint centerIndex = hexID * 3 * gl_WorkGroupSize.x * 2 + (mirrorFlip ? vertexCount : 0);
     vec4 centerPos = vertices[centerIndex];
-    bool insideHull = isInsideHull(centerPos);
+    bool insideHull = concaveHull ? hull_mask[hexID] != 0u : isInsideHull(centerPos);
 
     vec3 normal = tileNormalsEnabled && EPSILON < hexValue ? getRegressionPlaneNormal(ivec2(col, row)) : vec3(0.0);
 
@@ -142,7 +158,7 @@ void main() {
 
 
     // If this workgroups hex's neighbour is outside the edge, it's definitively part of the contouring edge
-    const bool neighborInsideHull = gridEdge ? false : isInsideHull(neighborPos);
+    const bool neighborInsideHull = gridEdge ? false : (concaveHull ? isInsideHullMask(neighbor) : isInsideHull(neighborPos));
     /*
      * This hexagon is only an edge if this hex is inside the hull but the neighbour isn't,
      * OR if the neighbour is but this one isn't
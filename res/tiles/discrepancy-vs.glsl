@@ -3,11 +3,15 @@
 #include "/defines.glsl"
 #include "/globals.glsl"
 
-layout(location = 1) in float discrepancy;
+layout(location = 1) in float maxDifference;
+layout(location = 2) in uint pointCount;
 
 uniform int numCols;
 uniform int numRows;
 uniform float discrepancyDiv;
+uniform float discrepancyEaseIn;
+uniform float discrepancyLowCount;
+uniform float maxPointCount;
 
 out vec4 tileDiscrepancy;
 
@@ -17,6 +21,13 @@ void main()
 	float col = mod(gl_VertexID,numCols);
     float row = gl_VertexID/numCols;
 
+    // ease in
+    float discrepancy = pow(max(0.05f, maxDifference), discrepancyEaseIn);
+
+    // account for tiles with few points
+    float relativeCount = float(pointCount) / max(maxPointCount, 1.0f);
+    discrepancy = min(discrepancy + discrepancyLowCount * (1 - relativeCount * relativeCount), 1.0f);
+
     // we only set the red channel, because we only use the color for additive blending
     tileDiscrepancy = vec4(1-discrepancy/discrepancyDiv,0.0f,0.0f,1.0f);
     //tileDiscrepancy = vec4(1-discrepancy,0.0f,0.0f,1.0f);
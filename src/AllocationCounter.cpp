@@ -0,0 +1,93 @@
+#include "AllocationCounter.h"
+
+#ifdef HAPTIC_ALLOCATION_CHECK
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    thread_local std::uint64_t allocation_count{0};
+
+    void *counted_allocation(std::size_t size) {
+        ++allocation_count;
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void *counted_aligned_allocation(std::size_t size, std::align_val_t alignment) {
+        ++allocation_count;
+        const auto align = static_cast<std::size_t>(alignment);
+        // aligned_alloc wants a size that is a multiple of the alignment
+        size = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+#ifdef _MSC_VER
+        return _aligned_malloc(size, align);
+#else
+        return std::aligned_alloc(align, size);
+#endif
+    }
+
+    void aligned_free(void *ptr) {
+#ifdef _MSC_VER
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+}
+
+// Replacements of the global allocation functions. The remaining forms (nothrow, ...) forward to these.
+void *operator new(std::size_t size) {
+    if (auto *ptr = counted_allocation(size))
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void *operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    if (auto *ptr = counted_aligned_allocation(size, alignment))
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    aligned_free(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    aligned_free(ptr);
+}
+
+std::optional<std::uint64_t> molumes::thread_allocation_count() {
+    return allocation_count;
+}
+
+#else
+
+std::optional<std::uint64_t> molumes::thread_allocation_count() {
+    return std::nullopt;
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef MOLUMES_ALLOCATIONCOUNTER_H
+#define MOLUMES_ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+#include <optional>
+
+namespace molumes {
+    /**
+     * @brief Number of heap allocations made by the calling thread so far
+     *
+     * Only available when built with HAPTIC_ALLOCATION_CHECK, which replaces the global operator new with a counting
+     * version (see AllocationCounter.cpp). Returns std::nullopt otherwise.
+     */
+    std::optional<std::uint64_t> thread_allocation_count();
+}
+
+#endif //MOLUMES_ALLOCATIONCOUNTER_H
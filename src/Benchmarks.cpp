@@ -0,0 +1,550 @@
+#include "Benchmarks.h"
+#include "CSV/CSVParser.h"
+#include "GeometryUtils.h"
+#include "MipPyramid.h"
+#include "Physics.h"
+#include "TextureSampler.h"
+#include "interactors/STLExporter.h"
+#include "renderer/CrystalRenderer.h"
+#include "renderer/tileRenderer/TileMapping.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <compare>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numbers>
+#include <optional>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+using namespace molumes;
+using namespace glm;
+namespace fs = std::filesystem;
+namespace chr = std::chrono;
+
+namespace {
+    // Milliseconds per repetition
+    double toMilliseconds(chr::steady_clock::duration duration, int repetitions = 1) {
+        return chr::duration<double, std::milli>(duration).count() / repetitions;
+    }
+
+    double toNanoseconds(chr::steady_clock::duration duration, std::size_t samples) {
+        return chr::duration<double, std::nano>(duration).count() / static_cast<double>(samples);
+    }
+
+    // Same grid as SquareTile::calculateNumberOfTiles
+    SquareTileMapping squareGrid(float tileSize, vec2 boundingBoxSize, vec2 minBounds) {
+        SquareTileMapping mapping;
+        mapping.cols = static_cast<int>(std::ceil(boundingBoxSize.x / tileSize));
+        mapping.rows = static_cast<int>(std::ceil(boundingBoxSize.y / tileSize));
+        mapping.maxX = mapping.cols - 1;
+        mapping.maxY = mapping.rows - 1;
+        mapping.minBounds = minBounds;
+        mapping.maxBounds = vec2(static_cast<float>(mapping.cols) * tileSize + minBounds.x,
+                                 static_cast<float>(mapping.rows) * tileSize + minBounds.y);
+        return mapping;
+    }
+
+    // Same grid as HexTile::calculateNumberOfTiles, radius is the distance from the center of a hexagon to a corner
+    HexTileMapping hexGrid(float radius, vec2 boundingBoxSize, vec2 minBounds) {
+        const float horizontalSpace = radius * 1.5f;
+        const float verticalSpace = std::sqrt(3.f) * radius;
+
+        HexTileMapping mapping;
+        mapping.rectHeight = verticalSpace / 2.0f;
+        mapping.rectWidth = radius;
+
+        const float colsTmp = 1 + boundingBoxSize.x / horizontalSpace;
+        mapping.cols = static_cast<int>(std::floor(colsTmp));
+        if ((colsTmp - static_cast<float>(mapping.cols)) * horizontalSpace >= radius)
+            mapping.cols += 1;
+
+        const float rowsTmp = 1 + boundingBoxSize.y / verticalSpace;
+        mapping.rows = static_cast<int>(std::floor(rowsTmp));
+        if ((rowsTmp - static_cast<float>(mapping.rows)) * verticalSpace >= verticalSpace / 2)
+            mapping.rows += 1;
+
+        mapping.maxRectCol = static_cast<int>(std::ceil(static_cast<float>(mapping.cols) * 1.5f)) -
+                             (mapping.cols % 2 == 1 ? 1 : 0);
+        mapping.maxRectRow = mapping.rows * 2;
+
+        mapping.minBounds = vec2(minBounds.x - radius / 2.0f, minBounds.y - verticalSpace / 2.0f);
+        mapping.maxBoundsRect = vec2(static_cast<float>(mapping.maxRectCol + 1) * mapping.rectWidth + mapping.minBounds.x,
+                                     static_cast<float>(mapping.maxRectRow + 1) * mapping.rectHeight + mapping.minBounds.y);
+        return mapping;
+    }
+
+    template<typename Mapping>
+    void benchmarkMapping(const std::string &name, const Mapping &mapping, std::span<const float> x,
+                          std::span<const float> y) {
+        constexpr int repetitions = 20;
+        std::vector<int> scalarIndices(x.size());
+        std::vector<int> batchIndices(x.size());
+
+        // single threaded in both cases, so only the mapping itself is compared
+        const auto scalarStart = chr::steady_clock::now();
+        for (int r = 0; r < repetitions; r++) {
+            for (std::size_t i = 0; i < x.size(); i++)
+                scalarIndices[i] = mapPointToTile(mapping, x[i], y[i]);
+        }
+        const auto batchStart = chr::steady_clock::now();
+        for (int r = 0; r < repetitions; r++)
+            mapPointsToTiles(mapping, x, y, batchIndices);
+        const auto batchEnd = chr::steady_clock::now();
+
+        std::cout << std::format("  {} ({} tiles): point by point {:.3f} ms, batched {:.3f} ms, {}", name,
+                                 mapping.cols * mapping.rows, toMilliseconds(batchStart - scalarStart, repetitions),
+                                 toMilliseconds(batchEnd - batchStart, repetitions),
+                                 scalarIndices == batchIndices ? "identical" : "MISMATCH") << std::endl;
+    }
+
+    template<int N>
+    std::weak_ordering
+    compareVec(const vec<N, float> &as, const vec<N, float> &bs, int i = 0, float epsilon = 0.0001f) {
+        return N <= i ? std::weak_ordering::equivalent : (as[i] < bs[i] + epsilon && bs[i] < as[i] + epsilon) ?
+                                                         compareVec(as, bs, i + 1, epsilon) :
+                                                         ((as[i] < bs[i]) ? std::weak_ordering::less
+                                                                          : std::weak_ordering::greater);
+    }
+
+    struct vec4_comparator {
+        auto operator()(const vec4 &lhs, const vec4 &rhs) const {
+            return compareVec(lhs, rhs) == std::weak_ordering::less;
+        }
+    };
+
+    /// Previous std::map based vertex welding of getVertexIndexPairs, returns the number of unique vertices
+    std::size_t mapWeldVertices(const std::vector<vec4> &vertices) {
+        std::map<vec4, unsigned int, vec4_comparator> lookupMap;
+        for (const auto &v: vertices)
+            lookupMap.emplace(v, static_cast<unsigned int>(lookupMap.size()));
+        return lookupMap.size();
+    }
+
+    /**
+     * Triangle soup of a grid of hexagon columns (top fan and side walls), similar in size and vertex sharing to
+     * the crystal geometry. Corners shared by neighbouring hexagons are calculated from each of their centers,
+     * so they only match within floating point precision.
+     */
+    std::vector<vec4> createHexagonGridMesh(std::size_t hexCount) {
+        const auto cols = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<float>(hexCount))));
+        const float radius = 1.f / static_cast<float>(cols);
+        const float colSpacing = 1.5f * radius;
+        const float rowSpacing = std::numbers::sqrt3_v<float> * radius;
+
+        std::vector<vec4> vertices;
+        vertices.reserve(hexCount * 6 * 9);
+        for (std::size_t i{0}; i < hexCount; ++i) {
+            const auto col = static_cast<float>(i % cols);
+            const auto row = static_cast<float>(i / cols);
+            // Every other column is shifted by half a row
+            const float rowOffset = (i % cols) % 2 == 0 ? 0.f : 0.5f * rowSpacing;
+            const vec2 center{col * colSpacing - 1.f, row * rowSpacing + rowOffset - 1.f};
+            const float height = 0.1f + 0.1f * std::sin(col * 0.3f + row * 0.2f);
+
+            const auto corner = [&](int k, float z) {
+                const float angle = static_cast<float>(k) * std::numbers::pi_v<float> / 3.f;
+                return vec4{center + radius * vec2{std::cos(angle), std::sin(angle)}, z, 1.f};
+            };
+
+            for (int k{0}; k < 6; ++k) {
+                vertices.insert(vertices.end(), {vec4{center, height, 1.f}, corner(k, height), corner(k + 1, height)});
+                vertices.insert(vertices.end(), {corner(k, height), corner(k, 0.f), corner(k + 1, height)});
+                vertices.insert(vertices.end(), {corner(k + 1, height), corner(k, 0.f), corner(k + 1, 0.f)});
+            }
+        }
+        return vertices;
+    }
+
+    /// Previous ASCII STL writer with a std::format and a flush per line, the baseline of STLExporter::writeAscii
+    template<typename Triangles>
+    void writeAsciiFormatted(std::ostream &os, const Triangles &triangles, const std::string &modelName) {
+        os << "solid " << modelName << std::endl;
+
+        for (const auto &[n, v1, v2, v3]: triangles) {
+            os << std::format("facet normal {:e} {:e} {:e}", n.x, n.y, n.z) << std::endl;
+            os << "    outer loop" << std::endl;
+            os << std::format("        vertex {:e} {:e} {:e}", v1.x, v1.y, v1.z) << std::endl;
+            os << std::format("        vertex {:e} {:e} {:e}", v2.x, v2.y, v2.z) << std::endl;
+            os << std::format("        vertex {:e} {:e} {:e}", v3.x, v3.y, v3.z) << std::endl;
+            os << "    endloop" << std::endl;
+            os << "endfacet" << std::endl;
+        }
+
+        os << "endsolid " << modelName;
+    }
+
+    /// Rolling hills, with the normal encoded in [0, 1] and the height in w, like the textures read back from the GPU
+    std::vector<vec4> rollingHills(uvec2 size) {
+        std::vector<vec4> texels(static_cast<std::size_t>(size.x) * size.y);
+        for (glm::uint y = 0; y < size.y; ++y) {
+            for (glm::uint x = 0; x < size.x; ++x) {
+                const auto u = static_cast<float>(x) * 0.02f, v = static_cast<float>(y) * 0.02f;
+                const auto normal = normalize(vec3{-std::cos(u) * std::cos(v), std::sin(u) * std::sin(v), 4.f});
+                texels[static_cast<std::size_t>(y) * size.x + x] = {normal * 0.5f + 0.5f,
+                                                                    0.5f + 0.25f * std::sin(u) * std::cos(v)};
+            }
+        }
+        return texels;
+    }
+
+    /// Previous mip pyramid generation, a serial 2x2 box filter of every level (odd sizes drop their last row/column)
+    void boxFilterSerial(MipPyramid &pyramid) {
+        for (std::size_t level = 1; level < MipPyramid::LevelCount; ++level) {
+            const auto srcDims = pyramid.dims(level - 1);
+            const auto dims = pyramid.dims(level);
+            const auto src = std::as_const(pyramid).level(level - 1);
+            const auto dst = pyramid.level(level);
+            for (glm::uint y = 0; y < dims.y; ++y) {
+                const auto *row0 = src.data() + static_cast<std::size_t>(2 * y) * srcDims.x;
+                const auto *row1 = row0 + srcDims.x;
+                for (glm::uint x = 0; x < dims.x; ++x) {
+                    const auto sum = row0[2 * x] + row0[2 * x + 1] + row1[2 * x] + row1[2 * x + 1];
+                    dst[static_cast<std::size_t>(y) * dims.x + x] = sum * 0.25f;
+                }
+            }
+        }
+    }
+
+    /**
+     * Height taps on a row-major mip map level, as the haptic textures were sampled before they were tiled. Same
+     * uv to texel mapping and clamping as SampledTexture, so the heights match it up to float rounding.
+     */
+    class RowMajorHeights {
+    public:
+        RowMajorHeights(std::span<const vec4> texels, uvec2 size) : m_texels{texels}, m_size{size} {
+            const auto s = vec2{size};
+            const float xMin = 0.5f - s.y / (s.x + s.x);
+            m_uvScale = vec2{(1.f - xMin - xMin) * (s.x + 1.f), s.y + 1.f};
+            m_uvOffset = vec2{xMin * (s.x + 1.f), 0.f};
+            m_maxCoord = s - 1.f;
+        }
+
+        [[nodiscard]] std::array<float, 4> gatherHeights(const std::array<vec2, 4> &uvs) const {
+            std::array<float, 4> out{};
+            for (std::size_t i = 0; i < 4; ++i) {
+                const auto coord = uvs[i] * m_uvScale + m_uvOffset;
+                const vec2 clamped{std::min(std::max(0.f, coord.x), m_maxCoord.x),
+                                   std::min(std::max(0.f, coord.y), m_maxCoord.y)};
+                const auto x0 = static_cast<std::size_t>(clamped.x);
+                const auto y0 = static_cast<std::size_t>(clamped.y);
+                const auto x1 = std::min<std::size_t>(x0 + 1, m_size.x - 1);
+                const auto row0 = y0 * m_size.x;
+                const auto row1 = std::min<std::size_t>(y0 + 1, m_size.y - 1) * m_size.x;
+                const auto fx = clamped.x - static_cast<float>(x0);
+                const auto fy = clamped.y - static_cast<float>(y0);
+                out[i] = std::lerp(std::lerp(m_texels[row0 + x0].w, m_texels[row0 + x1].w, fx),
+                                   std::lerp(m_texels[row1 + x0].w, m_texels[row1 + x1].w, fx), fy);
+            }
+            return out;
+        }
+
+    private:
+        std::span<const vec4> m_texels;
+        uvec2 m_size;
+        vec2 m_uvScale{0.f}, m_uvOffset{0.f}, m_maxCoord{0.f};
+    };
+
+    // The 4 central difference taps of a gradient around uv, as in Physics
+    std::array<vec2, 4> gradientTaps(const vec2 &uv, float kernel) {
+        return {vec2{std::min(uv.x + kernel, 1.f), uv.y}, vec2{std::max(uv.x - kernel, 0.f), uv.y},
+                vec2{uv.x, std::min(uv.y + kernel, 1.f)}, vec2{uv.x, std::max(uv.y - kernel, 0.f)}};
+    }
+
+    std::string readFile(const fs::path &path) {
+        std::stringstream content;
+        content << std::ifstream{path}.rdbuf();
+        return content.str();
+    }
+}
+
+int Benchmarks::run(const std::vector<std::string_view> &names) {
+    static constexpr std::array<std::pair<std::string_view, void (*)()>, 5> benchmarks{{
+            {"tiles", &Benchmarks::tileMapping},
+            {"welding", &Benchmarks::vertexWelding},
+            {"ascii", &Benchmarks::asciiExport},
+            {"haptics", &Benchmarks::hapticForces},
+            {"mipmaps", &Benchmarks::mipMaps}
+    }};
+
+    for (const auto &name: names) {
+        if (std::none_of(benchmarks.begin(), benchmarks.end(), [&name](const auto &b) { return b.first == name; })) {
+            std::cout << "Unknown benchmark " << name << ", available:";
+            for (const auto &b: benchmarks)
+                std::cout << " " << b.first;
+            std::cout << std::endl;
+            return 1;
+        }
+    }
+
+    for (const auto &[name, benchmark]: benchmarks) {
+        if (names.empty() || std::find(names.begin(), names.end(), name) != names.end())
+            benchmark();
+    }
+    return 0;
+}
+
+void Benchmarks::tileMapping() {
+    // The 50k point datasets (not the sampled subsets of them), with the first two columns as x and y like the viewer
+    std::vector<fs::path> files;
+    if (fs::is_directory("./dat")) {
+        for (const auto &entry: fs::directory_iterator{"./dat"}) {
+            const auto filename = entry.path().filename().string();
+            if (entry.path().extension() == ".csv" && filename.find("sampled") == std::string::npos &&
+                (filename.find("50000") != std::string::npos || filename.find("50.000") != std::string::npos))
+                files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    if (files.empty())
+        std::cout << "Tile mapping: no 50k datasets found in ./dat" << std::endl;
+
+    for (const auto &file: files) {
+        const auto parsed = parseCSV(file.string());
+        if (!parsed || parsed->columns.size() < 2 || parsed->columns[0].empty()) {
+            std::cout << "Tile mapping: failed to read " << file.string() << std::endl;
+            continue;
+        }
+        const std::span<const float> x = parsed->columns[0];
+        const std::span<const float> y = parsed->columns[1];
+
+        const auto [minX, maxX] = std::minmax_element(x.begin(), x.end());
+        const auto [minY, maxY] = std::minmax_element(y.begin(), y.end());
+        const vec2 minBounds{*minX, *minY};
+        const vec2 boundingBoxSize = vec2{*maxX, *maxY} - minBounds;
+        // about 64 tiles along the longer side, a grid of ~4k tiles for square data
+        const float tileSize = std::max(boundingBoxSize.x, boundingBoxSize.y) / 64.0f;
+
+        std::cout << std::format("Tile mapping of {} ({} points):", file.filename().string(), x.size()) << std::endl;
+        benchmarkMapping("Square", squareGrid(tileSize, boundingBoxSize, minBounds), x, y);
+        benchmarkMapping("Hexagon", hexGrid(tileSize / 1.5f, boundingBoxSize, minBounds), x, y);
+    }
+}
+
+void Benchmarks::vertexWelding() {
+    const auto vertices = createHexagonGridMesh(CrystalRenderer::MAX_HEXAGON_SIZE);
+
+    const auto mapStart = chr::steady_clock::now();
+    const auto mapUniqueCount = mapWeldVertices(vertices);
+    const auto hashStart = chr::steady_clock::now();
+    const auto [uniqueVertices, indices] = getVertexIndexPairs(vertices);
+    const auto hashEnd = chr::steady_clock::now();
+
+    std::cout << std::format("Vertex welding of a {} hexagon grid ({} vertices): std::map {:.1f} ms ({} unique), "
+                             "spatial hash {:.1f} ms ({} unique)", CrystalRenderer::MAX_HEXAGON_SIZE, vertices.size(),
+                             toMilliseconds(hashStart - mapStart), mapUniqueCount, toMilliseconds(hashEnd - hashStart),
+                             uniqueVertices.size()) << std::endl;
+}
+
+void Benchmarks::asciiExport() {
+    const auto vertices = createHexagonGridMesh(CrystalRenderer::MAX_HEXAGON_SIZE);
+    const auto path = fs::temp_directory_path() / "molumes-benchmark.stl-ascii";
+
+    // The previous writer got the welded triangles with their normals from the exporter before writing
+    const auto formattedStart = chr::steady_clock::now();
+    {
+        const auto [vs, indices] = getVertexIndexPairs(vertices);
+        std::vector<STLExporter::Triangle> triangles;
+        triangles.reserve(indices.size() / 3);
+        for (std::size_t i{0}; i < indices.size() / 3; ++i)
+            triangles.push_back(STLExporter::getTriangle(vs, indices, i));
+
+        std::ofstream ofs{path, std::ofstream::trunc | std::ofstream::out};
+        writeAsciiFormatted(ofs, triangles, STLExporter::defaultModelName);
+    }
+    const auto formattedEnd = chr::steady_clock::now();
+    const auto fileSize = fs::file_size(path);
+    const auto formatted = readFile(path);
+
+    const auto chunkedStart = chr::steady_clock::now();
+    {
+        std::ofstream ofs{path, std::ofstream::trunc | std::ofstream::out};
+        STLExporter::ExportProgress progress;
+        STLExporter::writeAscii(ofs, vertices, STLExporter::defaultModelName, CancellationToken{}, progress);
+    }
+    const auto chunkedEnd = chr::steady_clock::now();
+    const auto chunked = readFile(path);
+    fs::remove(path);
+
+    const auto megabytes = static_cast<double>(fileSize) / (1024.0 * 1024.0);
+    const auto throughput = [megabytes](chr::steady_clock::duration duration) {
+        return megabytes / chr::duration<double>(duration).count();
+    };
+    std::cout << std::format("ASCII export of a {} hexagon grid ({:.1f} MB): std::format + std::endl {:.0f} ms "
+                             "({:.1f} MB/s), to_chars chunks {:.0f} ms ({:.1f} MB/s), {}",
+                             CrystalRenderer::MAX_HEXAGON_SIZE, megabytes,
+                             toMilliseconds(formattedEnd - formattedStart), throughput(formattedEnd - formattedStart),
+                             toMilliseconds(chunkedEnd - chunkedStart), throughput(chunkedEnd - chunkedStart),
+                             formatted == chunked ? "identical" : "MISMATCH") << std::endl;
+}
+
+void Benchmarks::hapticForces() {
+    constexpr uvec2 textureSize{1920u, 1080u};
+    constexpr std::size_t sampleCount = 200000;
+
+    MipPyramid pyramid{textureSize, rollingHills(textureSize)};
+    pyramid.generate();
+    SampledMipPyramid mipMaps;
+    mipMaps.assign(pyramid);
+
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<float> planeDist{-0.95f, 0.95f}, heightDist{-0.2f, 0.2f}, uvDist{0.f, 1.f};
+    std::vector<dvec3> positions(sampleCount);
+    for (auto &p: positions)
+        p = {planeDist(rng), heightDist(rng), planeDist(rng)};
+    std::vector<vec2> uvs(sampleCount);
+    for (auto &uv: uvs)
+        uv = {uvDist(rng), uvDist(rng)};
+
+    std::cout << std::format("Haptics ({} samples, {}x{} texture):", sampleCount, textureSize.x, textureSize.y)
+              << std::endl;
+
+    const auto benchmarkForce = [&](const std::string &name, std::optional<unsigned int> volumeMipMaps,
+                                    std::optional<float> sphereKernelRadius, bool preInterpolativeNormal) {
+        Physics physics;
+        dvec3 sum{0.0};
+        const auto start = chr::steady_clock::now();
+        for (const auto &p: positions)
+            sum += physics.simulate_and_sample_force(6.0, 0.031f, 0.35f, 0, mipMaps, p, 0.23f, std::nullopt,
+                                                     volumeMipMaps, sphereKernelRadius, false, 1.3f,
+                                                     preInterpolativeNormal, false);
+        const auto end = chr::steady_clock::now();
+        std::cout << std::format("  {}: {:.1f} ns per force sample (checksum {:.3f})", name,
+                                 toNanoseconds(end - start, sampleCount), sum.x + sum.y + sum.z) << std::endl;
+    };
+    benchmarkForce("Surface, post-interpolated normals", std::nullopt, std::nullopt, false);
+    benchmarkForce("Surface, pre-interpolated normals", std::nullopt, std::nullopt, true);
+    benchmarkForce("Surface volume", HapticMipMapLevels / 3, std::nullopt, true);
+    benchmarkForce("Surface volume, Monte Carlo", HapticMipMapLevels / 3, 0.008f, true);
+
+    // Texture lookups on their own
+    const auto &texture = mipMaps.at(0);
+    float sum{0.f};
+    const auto sampleStart = chr::steady_clock::now();
+    for (const auto &uv: uvs)
+        sum += texture.sample(uv).w;
+    const auto heightStart = chr::steady_clock::now();
+    for (const auto &uv: uvs)
+        sum += texture.sample_height(uv);
+    const auto gatherStart = chr::steady_clock::now();
+    for (const auto &uv: uvs) {
+        const auto h = texture.gather_heights({uv, uv + vec2{0.001f, 0.f}, uv, uv + vec2{0.f, 0.001f}});
+        sum += h[0] + h[1] + h[2] + h[3];
+    }
+    const auto heightsStart = chr::steady_clock::now();
+    for (const auto &uv: uvs)
+        sum += texture.sample_height(uv) + texture.sample_height(uv + vec2{0.001f, 0.f}) +
+               texture.sample_height(uv) + texture.sample_height(uv + vec2{0.f, 0.001f});
+    const auto heightsEnd = chr::steady_clock::now();
+    std::cout << std::format("  Texture: sample {:.1f} ns, sample_height {:.1f} ns, gather_heights (4 taps) {:.1f} ns, "
+                             "4 x sample_height {:.1f} ns (checksum {:.3f})",
+                             toNanoseconds(heightStart - sampleStart, sampleCount),
+                             toNanoseconds(gatherStart - heightStart, sampleCount),
+                             toNanoseconds(heightsStart - gatherStart, sampleCount),
+                             toNanoseconds(heightsEnd - heightsStart, sampleCount), sum) << std::endl;
+}
+
+void Benchmarks::mipMaps() {
+    constexpr uvec2 textureSize{3840u, 2160u};
+    constexpr std::size_t sampleCount = 200000;
+    constexpr int assignRepetitions = 10;
+    // Gradient kernel and the pair of levels its taps are read from, as in the surface volume gradient
+    constexpr float kernel = 0.001f;
+    constexpr std::array<std::size_t, 2> levels{0, 1};
+
+    const auto texels = rollingHills(textureSize);
+    const auto copyStart = chr::steady_clock::now();
+    MipPyramid pyramid{textureSize, texels};
+    const auto generateStart = chr::steady_clock::now();
+    pyramid.generate();
+    const auto generateEnd = chr::steady_clock::now();
+
+    MipPyramid serialPyramid{textureSize, texels};
+    const auto serialStart = chr::steady_clock::now();
+    boxFilterSerial(serialPyramid);
+    const auto serialEnd = chr::steady_clock::now();
+
+    // The first assign allocates the sampling storage, the later ones reuse it like the updates in the viewer do
+    SampledMipPyramid sampled;
+    const auto firstAssignStart = chr::steady_clock::now();
+    sampled.assign(pyramid);
+    const auto assignStart = chr::steady_clock::now();
+    for (int r = 0; r < assignRepetitions; r++)
+        sampled.assign(pyramid);
+    const auto assignEnd = chr::steady_clock::now();
+
+    std::cout << std::format("Mip maps ({}x{} texture, {} samples):", textureSize.x, textureSize.y, sampleCount)
+              << std::endl;
+    std::cout << std::format("  MipPyramid: copy level 0 {:.2f} ms, generate {:.2f} ms (serial box filter {:.2f} ms)",
+                             toMilliseconds(generateStart - copyStart), toMilliseconds(generateEnd - generateStart),
+                             toMilliseconds(serialEnd - serialStart)) << std::endl;
+    std::cout << std::format("  SampledMipPyramid::assign: {:.2f} ms allocating, {:.2f} ms reusing the storage",
+                             toMilliseconds(assignStart - firstAssignStart),
+                             toMilliseconds(assignEnd - assignStart, assignRepetitions)) << std::endl;
+
+    const std::array<RowMajorHeights, 2> rowMajor{RowMajorHeights{pyramid.level(levels[0]), pyramid.dims(levels[0])},
+                                                  RowMajorHeights{pyramid.level(levels[1]), pyramid.dims(levels[1])}};
+    const std::array<const SampledTexture *, 2> tiled{&sampled.at(levels[0]), &sampled.at(levels[1])};
+
+    // Random positions miss the cache on every sample, while a walk moves a few texels per sample like the device
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<float> uvDist{0.f, 1.f}, stepDist{-0.0002f, 0.0002f};
+    std::vector<vec2> randomUvs(sampleCount), walkUvs(sampleCount);
+    for (auto &uv: randomUvs)
+        uv = {uvDist(rng), uvDist(rng)};
+    vec2 walk{0.5f, 0.5f};
+    for (auto &uv: walkUvs) {
+        walk = {std::clamp(walk.x + stepDist(rng), 0.f, 1.f), std::clamp(walk.y + stepDist(rng), 0.f, 1.f)};
+        uv = walk;
+    }
+
+    const auto benchmarkTaps = [&](const std::string &name, const std::vector<vec2> &uvs) {
+        float rowMajorSum{0.f}, tiledSum{0.f}, maxDifference{0.f};
+        const auto rowMajorStart = chr::steady_clock::now();
+        for (const auto &uv: uvs) {
+            const auto taps = gradientTaps(uv, kernel);
+            const auto h0 = rowMajor[0].gatherHeights(taps);
+            const auto h1 = rowMajor[1].gatherHeights(taps);
+            rowMajorSum += h0[0] - h0[1] + h0[2] - h0[3] + h1[0] - h1[1] + h1[2] - h1[3];
+        }
+        const auto tiledStart = chr::steady_clock::now();
+        for (const auto &uv: uvs) {
+            const auto taps = gradientTaps(uv, kernel);
+            const auto h0 = tiled[0]->gather_heights(taps);
+            const auto h1 = tiled[1]->gather_heights(taps);
+            tiledSum += h0[0] - h0[1] + h0[2] - h0[3] + h1[0] - h1[1] + h1[2] - h1[3];
+        }
+        const auto tiledEnd = chr::steady_clock::now();
+
+        // Compared separately, so the timed loops only sample
+        for (const auto &uv: uvs) {
+            const auto taps = gradientTaps(uv, kernel);
+            for (std::size_t l = 0; l < levels.size(); ++l) {
+                const auto expected = rowMajor[l].gatherHeights(taps);
+                const auto actual = tiled[l]->gather_heights(taps);
+                for (std::size_t i = 0; i < 4; ++i)
+                    maxDifference = std::max(maxDifference, std::abs(expected[i] - actual[i]));
+            }
+        }
+
+        std::cout << std::format("  Gradient taps on levels {} and {}, {}: row-major {:.1f} ns, tiled {:.1f} ns "
+                                 "(checksums {:.3f} and {:.3f}, largest difference {:.2e})", levels[0], levels[1],
+                                 name, toNanoseconds(tiledStart - rowMajorStart, uvs.size()),
+                                 toNanoseconds(tiledEnd - tiledStart, uvs.size()), rowMajorSum, tiledSum,
+                                 maxDifference) << std::endl;
+    };
+    benchmarkTaps("random positions", randomUvs);
+    benchmarkTaps("walking positions", walkUvs);
+}
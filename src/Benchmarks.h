@@ -0,0 +1,34 @@
+#ifndef MOLUMES_BENCHMARKS_H
+#define MOLUMES_BENCHMARKS_H
+
+#include <string_view>
+#include <vector>
+
+namespace molumes {
+    /**
+     * @brief Benchmark mode: times CPU code paths against the implementations they replaced, headless (before GLFW is
+     * started), on the datasets in ./dat or on generated data. Results are printed to stdout.
+     *
+     * molumes --benchmark [name]...   runs the named benchmarks, or all of them if no name is given
+     */
+    class Benchmarks {
+    public:
+        /// Runs the benchmarks and returns the exit code of the application (1 for an unknown benchmark name)
+        static int run(const std::vector<std::string_view> &names);
+
+    private:
+        /// Per point and batched point to tile mapping on the 50k datasets, for square and hexagon grids
+        static void tileMapping();
+        /// Vertex welding of a crystal sized hexagon grid, with the previous std::map welder and getVertexIndexPairs
+        static void vertexWelding();
+        /// ASCII STL export of a crystal sized hexagon grid, with the previous std::format writer and writeAscii
+        static void asciiExport();
+        /// Force samples and texture lookups of the haptic loop on a full HD texture
+        static void hapticForces();
+        /// Generation of a 4K mip pyramid and its conversion for sampling, and gradient taps on its row-major and its
+        /// tiled levels
+        static void mipMaps();
+    };
+}
+
+#endif //MOLUMES_BENCHMARKS_H
@@ -0,0 +1,488 @@
+#include "CSVParser.h"
+#include "../MappedFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
+#include <omp.h>
+
+using namespace molumes;
+
+namespace
+{
+	constexpr char separator = ',';
+	constexpr char quote = '"';
+
+	// smallest byte range handed to a single worker
+	constexpr std::size_t minChunkSize = 1 << 20;
+
+	// smallest number of rows handed to a single worker when parsing a column from the row index
+	constexpr std::size_t minRowsPerTask = 1 << 14;
+
+	// rows used to decide which columns are numeric when a file is not parsed completely up front
+	constexpr std::size_t columnDetectionRowCount = 1024;
+
+	std::string_view trim(std::string_view str)
+	{
+		const auto first = str.find_first_not_of(" \t\r");
+		if (first == std::string_view::npos)
+			return {};
+		const auto last = str.find_last_not_of(" \t\r");
+		return str.substr(first, last - first + 1);
+	}
+
+	// Splits off the next cell of a line (respecting quoted cells) and advances the line past its separator
+	std::string_view nextCell(std::string_view& line)
+	{
+		std::size_t end = 0;
+		if (!line.empty() && line.front() == quote)
+		{
+			// skip to the closing quote, "" is an escaped quote inside the cell
+			end = 1;
+			while (end < line.size())
+			{
+				if (line[end] == quote)
+				{
+					if (end + 1 < line.size() && line[end + 1] == quote)
+					{
+						end += 2;
+						continue;
+					}
+					break;
+				}
+				++end;
+			}
+		}
+		end = line.find(separator, end);
+
+		const auto cell = line.substr(0, end);
+		line = (end == std::string_view::npos) ? std::string_view{} : line.substr(end + 1);
+		return cell;
+	}
+
+	std::string_view unquote(std::string_view cell)
+	{
+		cell = trim(cell);
+		if (cell.size() >= 2 && cell.front() == quote && cell.back() == quote)
+			cell = trim(cell.substr(1, cell.size() - 2));
+		return cell;
+	}
+
+	bool parseFloat(std::string_view cell, float& value)
+	{
+		cell = unquote(cell);
+		if (cell.empty())
+		{
+			value = 0.f;
+			return true;
+		}
+
+		// from_chars does not accept an explicit plus sign
+		if (cell.front() == '+')
+			cell.remove_prefix(1);
+
+		const auto [ptr, ec] = std::from_chars(cell.data(), cell.data() + cell.size(), value);
+		return ec == std::errc() && ptr == cell.data() + cell.size();
+	}
+
+	// Returns the next non-empty line in [begin, end) with any trailing '\r' removed and advances begin past it
+	std::optional<std::string_view> nextLine(const char*& begin, const char* end)
+	{
+		while (begin < end)
+		{
+			const auto* eol = static_cast<const char*>(std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+			if (eol == nullptr)
+				eol = end;
+
+			std::string_view line{ begin, static_cast<std::size_t>(eol - begin) };
+			if (!line.empty() && line.back() == '\r')
+				line.remove_suffix(1);
+
+			begin = (eol == end) ? end : eol + 1;
+			if (!line.empty())
+				return line;
+		}
+		return std::nullopt;
+	}
+
+	// Calls func for every non-empty line in [begin, end)
+	template <typename F>
+	void forEachLine(const char* begin, const char* end, F&& func)
+	{
+		while (const auto line = nextLine(begin, end))
+			func(*line);
+	}
+
+	// Skips a UTF-8 byte order mark, parses the header row and advances begin to the first row of the body
+	std::vector<std::string> parseHeader(const char*& begin, const char* end)
+	{
+		if (end - begin >= 3 && std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0)
+			begin += 3;
+
+		std::vector<std::string> names;
+		if (const auto header = nextLine(begin, end))
+		{
+			for (auto line = *header; !line.empty();)
+				names.emplace_back(unquote(nextCell(line)));
+		}
+		return names;
+	}
+
+	struct Chunk
+	{
+		const char* begin;
+		const char* end;
+		std::size_t firstRow = 0;
+		std::size_t rowCount = 0;
+	};
+
+	// Splits [begin, end) into ranges that start right after a line break
+	std::vector<Chunk> splitIntoChunks(const char* begin, const char* end)
+	{
+		const auto size = static_cast<std::size_t>(end - begin);
+		const auto threadCount = static_cast<std::size_t>(omp_get_max_threads());
+		const auto chunkCount = std::clamp<std::size_t>(size / minChunkSize, 1, threadCount);
+		const auto chunkSize = size / chunkCount;
+
+		std::vector<Chunk> chunks;
+		const char* chunkBegin = begin;
+		for (std::size_t i = 0; i < chunkCount && chunkBegin < end; ++i)
+		{
+			const char* chunkEnd = end;
+			if (i + 1 < chunkCount)
+			{
+				chunkEnd = std::max(chunkBegin, begin + (i + 1) * chunkSize);
+				const auto* eol = static_cast<const char*>(std::memchr(chunkEnd, '\n', static_cast<std::size_t>(end - chunkEnd)));
+				chunkEnd = (eol == nullptr) ? end : eol + 1;
+			}
+			chunks.push_back({ chunkBegin, chunkEnd });
+			chunkBegin = chunkEnd;
+		}
+		return chunks;
+	}
+
+	// Runs func(chunk) for every chunk in parallel (OpenMP) and waits for all of them
+	template <typename F>
+	void forEachChunk(std::vector<Chunk>& chunks, F&& func)
+	{
+		// chunks end at line breaks, so their sizes differ and they are handed out dynamically
+#pragma omp parallel for schedule(dynamic) if (chunks.size() > 1)
+		for (std::int64_t i = 0; i < static_cast<std::int64_t>(chunks.size()); i++)
+			func(chunks[static_cast<std::size_t>(i)]);
+	}
+
+	// Calls func(begin, end) on sub-ranges of [0, count) in parallel (OpenMP) and waits for all of them
+	template <typename F>
+	void parallelFor(std::size_t count, std::size_t minPerTask, F&& func)
+	{
+		const auto threadCount = static_cast<std::size_t>(omp_get_max_threads());
+		const auto taskCount = std::clamp<std::size_t>(count / std::max<std::size_t>(minPerTask, 1), 1, threadCount);
+		const auto perTask = (count + taskCount - 1) / taskCount;
+
+#pragma omp parallel for schedule(dynamic) if (taskCount > 1)
+		for (std::int64_t task = 0; task < static_cast<std::int64_t>(taskCount); task++)
+		{
+			const auto begin = static_cast<std::size_t>(task) * perTask;
+			if (begin < count)
+				func(begin, std::min(count, begin + perTask));
+		}
+	}
+
+	// Marks every column with a non-numeric cell in the first rows of [begin, end)
+	std::vector<char> detectNumericColumns(const char* begin, const char* end, std::size_t columnCount, std::size_t rowCount)
+	{
+		std::vector<char> numeric(columnCount, 1);
+		for (std::size_t row = 0; row < rowCount; ++row)
+		{
+			auto line = nextLine(begin, end);
+			if (!line)
+				break;
+
+			float value;
+			for (std::size_t col = 0; col < columnCount && !line->empty(); ++col)
+			{
+				const auto cell = nextCell(*line);
+				if (numeric[col] && !parseFloat(cell, value))
+					numeric[col] = 0;
+			}
+		}
+		return numeric;
+	}
+
+	// Counts the rows of every chunk in parallel, sets their first row and returns the total number of rows
+	std::size_t countRows(std::vector<Chunk>& chunks)
+	{
+		forEachChunk(chunks, [](Chunk& chunk) {
+			forEachLine(chunk.begin, chunk.end, [&chunk](std::string_view) { ++chunk.rowCount; });
+		});
+
+		std::size_t rowCount = 0;
+		for (auto& chunk : chunks)
+		{
+			chunk.firstRow = rowCount;
+			rowCount += chunk.rowCount;
+		}
+		return rowCount;
+	}
+}
+
+std::optional<CSVColumns> molumes::parseCSV(const std::string& filename)
+{
+	const auto file = MappedFile::open(filename);
+	if (!file)
+		return std::nullopt;
+
+	const auto* begin = reinterpret_cast<const char*>(file->data());
+	const auto* end = begin + file->size();
+
+	auto names = parseHeader(begin, end);
+	const auto columnCount = names.size();
+
+	// pass 1: count rows per chunk so every worker knows where its rows end up in the columns
+	auto chunks = splitIntoChunks(begin, end);
+	const auto rowCount = countRows(chunks);
+
+	// pass 2: parse cells straight into the float columns
+	std::vector<std::vector<float>> columns(columnCount, std::vector<float>(rowCount, 0.f));
+	std::vector<std::vector<char>> chunkNumeric(chunks.size(), std::vector<char>(columnCount, 1));
+
+	forEachChunk(chunks, [&](Chunk& chunk) {
+		auto& numeric = chunkNumeric[&chunk - chunks.data()];
+		auto row = chunk.firstRow;
+		forEachLine(chunk.begin, chunk.end, [&](std::string_view line) {
+			for (std::size_t col = 0; col < columnCount && !line.empty(); ++col)
+			{
+				const auto cell = nextCell(line);
+				if (numeric[col] && !parseFloat(cell, columns[col][row]))
+					numeric[col] = 0;
+			}
+			++row;
+		});
+	});
+
+	// drop columns that had a non-numeric cell in any chunk
+	CSVColumns result;
+	for (std::size_t col = 0; col < columnCount; ++col)
+	{
+		const bool isNumeric = rowCount > 0 && std::all_of(chunkNumeric.begin(), chunkNumeric.end(), [col](const auto& numeric) { return numeric[col] != 0; });
+		if (isNumeric)
+		{
+			result.columnNames.push_back(std::move(names[col]));
+			result.columns.push_back(std::move(columns[col]));
+		}
+		else
+		{
+			// release memory of dropped columns right away
+			std::vector<float>{}.swap(columns[col]);
+		}
+	}
+
+	return result;
+}
+
+std::optional<std::vector<std::string>> molumes::readCSVHeader(const std::string& filename)
+{
+	const auto file = MappedFile::open(filename);
+	if (!file)
+		return std::nullopt;
+
+	const auto* begin = reinterpret_cast<const char*>(file->data());
+	return parseHeader(begin, begin + file->size());
+}
+
+std::optional<CSVStreamReader> CSVStreamReader::open(const std::string& filename, std::size_t chunkRowCount)
+{
+	auto file = MappedFile::open(filename);
+	if (!file)
+		return std::nullopt;
+
+	CSVStreamReader reader;
+	reader.m_chunkRowCount = std::max<std::size_t>(chunkRowCount, 1);
+
+	const auto* begin = reinterpret_cast<const char*>(file->data());
+	const auto* end = begin + file->size();
+
+	auto names = parseHeader(begin, end);
+	reader.m_fileColumnCount = names.size();
+
+	// row count is known up front so the table can reserve its columns once
+	auto chunks = splitIntoChunks(begin, end);
+	reader.m_rowCount = countRows(chunks);
+
+	// non-numeric columns are dropped by read() as soon as it finds a non-numeric cell in them
+	reader.m_columnSlots.resize(names.size());
+	for (std::size_t col = 0; col < names.size(); ++col)
+		reader.m_columnSlots[col] = static_cast<int>(col);
+	reader.m_columnNames = std::move(names);
+
+	reader.m_position = begin;
+	reader.m_end = end;
+	reader.m_file = std::move(*file);
+	return reader;
+}
+
+const std::vector<std::string>& CSVStreamReader::columnNames() const
+{
+	return m_columnNames;
+}
+
+std::size_t CSVStreamReader::rowCount() const
+{
+	return m_rowCount;
+}
+
+bool CSVStreamReader::read(std::vector<std::vector<float>>& columns, std::vector<std::size_t>& droppedColumns)
+{
+	columns.resize(m_columnNames.size());
+	for (auto& column : columns)
+	{
+		column.clear();
+		column.reserve(m_chunkRowCount);
+	}
+
+	std::vector<char> numeric(m_columnNames.size(), 1);
+	std::size_t rows = 0;
+	for (; rows < m_chunkRowCount; ++rows)
+	{
+		auto line = nextLine(m_position, m_end);
+		if (!line)
+			break;
+
+		for (std::size_t col = 0; col < m_fileColumnCount; ++col)
+		{
+			const auto cell = line->empty() ? std::string_view{} : nextCell(*line);
+			const auto slot = m_columnSlots[col];
+			if (slot < 0)
+				continue;
+
+			float value;
+			if (!parseFloat(cell, value))
+			{
+				value = 0.f;
+				numeric[slot] = 0;
+			}
+			columns[slot].push_back(value);
+		}
+	}
+
+	// drop the columns that turned out to be non-numeric, the remaining ones move up to close the gaps
+	droppedColumns.clear();
+	for (std::size_t slot = 0; slot < numeric.size(); ++slot)
+	{
+		if (!numeric[slot])
+			droppedColumns.push_back(slot);
+	}
+	if (!droppedColumns.empty())
+	{
+		for (auto slot = droppedColumns.rbegin(); slot != droppedColumns.rend(); ++slot)
+		{
+			columns.erase(columns.begin() + static_cast<std::ptrdiff_t>(*slot));
+			m_columnNames.erase(m_columnNames.begin() + static_cast<std::ptrdiff_t>(*slot));
+		}
+
+		for (auto& slot : m_columnSlots)
+		{
+			if (slot < 0)
+				continue;
+			const auto index = static_cast<std::size_t>(slot);
+			const auto droppedBefore = std::lower_bound(droppedColumns.begin(), droppedColumns.end(), index) - droppedColumns.begin();
+			slot = numeric[index] ? slot - static_cast<int>(droppedBefore) : -1;
+		}
+	}
+
+	return rows > 0;
+}
+
+std::optional<CSVColumnIndex> CSVColumnIndex::open(const std::string& filename)
+{
+	auto file = MappedFile::open(filename);
+	if (!file)
+		return std::nullopt;
+
+	const auto* data = reinterpret_cast<const char*>(file->data());
+	const auto* begin = data;
+	const auto* end = data + file->size();
+
+	auto names = parseHeader(begin, end);
+
+	// scan: count rows per chunk, then record the offset of every row
+	auto chunks = splitIntoChunks(begin, end);
+	const auto rowCount = countRows(chunks);
+
+	CSVColumnIndex index;
+	index.m_rowOffsets.resize(rowCount + 1);
+	index.m_rowOffsets[rowCount] = file->size();
+
+	forEachChunk(chunks, [&](Chunk& chunk) {
+		auto row = chunk.firstRow;
+		forEachLine(chunk.begin, chunk.end, [&](std::string_view line) {
+			index.m_rowOffsets[row++] = static_cast<std::uint64_t>(line.data() - data);
+		});
+	});
+
+	const auto numeric = detectNumericColumns(begin, end, names.size(), columnDetectionRowCount);
+	for (std::size_t col = 0; col < names.size(); ++col)
+	{
+		if (numeric[col] && rowCount > 0)
+		{
+			index.m_columnNames.push_back(std::move(names[col]));
+			index.m_fileColumns.push_back(col);
+		}
+	}
+
+	index.m_file = std::move(*file);
+	return index;
+}
+
+const std::vector<std::string>& CSVColumnIndex::columnNames() const
+{
+	return m_columnNames;
+}
+
+std::size_t CSVColumnIndex::rowCount() const
+{
+	return m_rowOffsets.empty() ? 0 : m_rowOffsets.size() - 1;
+}
+
+std::optional<std::vector<float>> CSVColumnIndex::parseColumn(std::size_t column) const
+{
+	std::vector<float> values(rowCount(), 0.f);
+	if (column >= m_fileColumns.size())
+		return values;
+
+	const auto fileColumn = m_fileColumns[column];
+	const auto* data = reinterpret_cast<const char*>(m_file.data());
+	std::atomic<bool> numeric{ true };
+
+	parallelFor(values.size(), minRowsPerTask, [&](std::size_t begin, std::size_t end) {
+		for (auto row = begin; row < end && numeric.load(std::memory_order_relaxed); ++row)
+		{
+			// a row ends where the next one starts, minus the line break and any empty lines in between
+			std::string_view line{ data + m_rowOffsets[row], static_cast<std::size_t>(m_rowOffsets[row + 1] - m_rowOffsets[row]) };
+			const auto last = line.find_last_not_of("\r\n");
+			line = line.substr(0, last == std::string_view::npos ? 0 : last + 1);
+
+			for (std::size_t col = 0; col < fileColumn && !line.empty(); ++col)
+				nextCell(line);
+
+			if (!line.empty() && !parseFloat(nextCell(line), values[row]))
+				numeric.store(false, std::memory_order_relaxed);
+		}
+	});
+
+	if (!numeric)
+		return std::nullopt;
+	return values;
+}
+
+void CSVColumnIndex::dropColumn(std::size_t column)
+{
+	if (column >= m_fileColumns.size())
+		return;
+
+	m_columnNames.erase(m_columnNames.begin() + static_cast<std::ptrdiff_t>(column));
+	m_fileColumns.erase(m_fileColumns.begin() + static_cast<std::ptrdiff_t>(column));
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "../MappedFile.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace molumes
+{
+	struct CSVColumns
+	{
+		std::vector<std::string> columnNames;
+		std::vector<std::vector<float>> columns;
+	};
+
+	/**
+	 * @brief Parses the numeric columns of a comma separated file with a header row.
+	 *
+	 * The file is memory-mapped and split into line aligned byte ranges which are parsed in parallel directly into
+	 * float columns. Columns containing a cell that is not a number (e.g. "Country") are detected during the same
+	 * pass and dropped, so no string cells are ever kept in memory. Empty or missing cells are read as 0.
+	 * Returns std::nullopt if the file could not be opened.
+	 */
+	std::optional<CSVColumns> parseCSV(const std::string& filename);
+
+	/**
+	 * @brief Reads only the header row of a CSV file, numeric and non-numeric columns alike.
+	 *
+	 * The rest of the file is not touched. Returns std::nullopt if the file could not be opened.
+	 */
+	std::optional<std::vector<std::string>> readCSVHeader(const std::string& filename);
+
+	/**
+	 * @brief Reads the numeric columns of a CSV file incrementally, a chunk of rows at a time.
+	 *
+	 * The number of rows is counted when the file is opened. Every column of the header starts out numeric; like
+	 * parseCSV(), a column with a non-numeric cell is dropped and read() reports it with the chunk it was found in.
+	 */
+	class CSVStreamReader
+	{
+	public:
+		static std::optional<CSVStreamReader> open(const std::string& filename, std::size_t chunkRowCount);
+
+		const std::vector<std::string>& columnNames() const;
+		std::size_t rowCount() const;
+
+		/**
+		 * Parses the next chunk of rows into one vector per numeric column. Returns false once every row was read.
+		 * droppedColumns receives the columns (indices into columnNames() before the call) that had a non-numeric
+		 * cell in this chunk. They are left out of this and every later chunk, and removed from columnNames().
+		 */
+		bool read(std::vector<std::vector<float>>& columns, std::vector<std::size_t>& droppedColumns);
+
+	private:
+		MappedFile m_file;
+		const char* m_position = nullptr;
+		const char* m_end = nullptr;
+
+		std::size_t m_chunkRowCount = 0;
+		std::size_t m_rowCount = 0;
+		std::size_t m_fileColumnCount = 0;
+		std::vector<std::string> m_columnNames;
+
+		// index into the numeric columns for every column of the file, -1 for dropped columns
+		std::vector<int> m_columnSlots;
+	};
+
+	/**
+	 * @brief Row index of a CSV file that parses single columns on demand.
+	 *
+	 * Opening the file scans it once to record the byte offset of every row. Numeric columns are determined from the
+	 * first rows. Like parseCSV(), a column that has a non-numeric cell in a later row is not numeric after all:
+	 * parseColumn() fails for it and it should be removed with dropColumn().
+	 */
+	class CSVColumnIndex
+	{
+	public:
+		static std::optional<CSVColumnIndex> open(const std::string& filename);
+
+		// names of the numeric columns
+		const std::vector<std::string>& columnNames() const;
+		std::size_t rowCount() const;
+
+		// parses a numeric column (index into columnNames()) in parallel using the row index. Returns std::nullopt if
+		// the column has a non-numeric cell
+		std::optional<std::vector<float>> parseColumn(std::size_t column) const;
+
+		// removes a column that turned out to be non-numeric, the columns after it move down
+		void dropColumn(std::size_t column);
+
+	private:
+		MappedFile m_file;
+
+		// byte offset of the start of every row, followed by the end of the file
+		std::vector<std::uint64_t> m_rowOffsets;
+
+		std::vector<std::string> m_columnNames;
+		// position of every numeric column in the rows of the file
+		std::vector<std::size_t> m_fileColumns;
+	};
+}
@@ -0,0 +1,146 @@
+#include "PointCloudFile.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace molumes;
+
+namespace
+{
+	constexpr std::array<char, 8> fileMagic{ 'M', 'O', 'L', 'P', 'T', 'C', 'L', 'D' };
+	constexpr std::uint32_t fileVersion = 1;
+	constexpr std::uint64_t dataAlignment = 64;
+
+	struct Header
+	{
+		std::array<char, 8> magic;
+		std::uint32_t version;
+		std::uint32_t columnCount;
+		std::uint64_t rowCount;
+		std::uint64_t dataOffset;
+	};
+	static_assert(sizeof(Header) == 32, "Header layout has to match the documented format");
+
+	// the format is little-endian and the columns are exposed without conversion
+	constexpr bool nativeLittleEndian = std::endian::native == std::endian::little;
+}
+
+std::optional<PointCloudFile> PointCloudFile::open(const std::string& filename)
+{
+	if constexpr (!nativeLittleEndian)
+		return std::nullopt;
+
+	auto file = MappedFile::open(filename);
+	if (!file || file->size() < sizeof(Header))
+		return std::nullopt;
+
+	Header header;
+	std::memcpy(&header, file->data(), sizeof(Header));
+	if (header.magic != fileMagic || header.version != fileVersion || header.dataOffset % dataAlignment != 0)
+		return std::nullopt;
+
+	const auto dataSize = std::uint64_t{ header.columnCount } * header.rowCount * sizeof(float);
+	if (header.dataOffset > file->size() || file->size() - header.dataOffset != dataSize)
+		return std::nullopt;
+
+	PointCloudFile pointCloud;
+	pointCloud.m_columnNames.reserve(header.columnCount);
+
+	std::size_t offset = sizeof(Header);
+	for (std::uint32_t i = 0; i < header.columnCount; ++i)
+	{
+		std::uint32_t length;
+		if (offset + sizeof(length) > header.dataOffset)
+			return std::nullopt;
+		std::memcpy(&length, file->data() + offset, sizeof(length));
+		offset += sizeof(length);
+
+		if (offset + length > header.dataOffset)
+			return std::nullopt;
+		pointCloud.m_columnNames.emplace_back(reinterpret_cast<const char*>(file->data() + offset), length);
+		offset += length;
+	}
+
+	pointCloud.m_rowCount = header.rowCount;
+	pointCloud.m_dataOffset = header.dataOffset;
+	pointCloud.m_file = std::move(*file);
+	return pointCloud;
+}
+
+bool PointCloudFile::write(const std::string& filename, const std::vector<std::string>& columnNames, const std::vector<std::span<const float>>& columns)
+{
+	if constexpr (!nativeLittleEndian)
+		return false;
+
+	if (columnNames.size() != columns.size())
+		return false;
+
+	const std::uint64_t rowCount = columns.empty() ? 0 : columns.front().size();
+	if (std::any_of(columns.begin(), columns.end(), [rowCount](const auto& col) { return col.size() != rowCount; }))
+		return false;
+
+	std::uint64_t namesSize = 0;
+	for (const auto& name : columnNames)
+		namesSize += sizeof(std::uint32_t) + name.size();
+
+	Header header{};
+	header.magic = fileMagic;
+	header.version = fileVersion;
+	header.columnCount = static_cast<std::uint32_t>(columns.size());
+	header.rowCount = rowCount;
+	header.dataOffset = (sizeof(Header) + namesSize + dataAlignment - 1) / dataAlignment * dataAlignment;
+
+	// write to a temporary file first so readers never see a partially written point cloud
+	const auto tmpFilename = filename + ".tmp";
+	{
+		std::ofstream out{ tmpFilename, std::ios::binary | std::ios::trunc };
+		if (!out)
+			return false;
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		for (const auto& name : columnNames)
+		{
+			const auto length = static_cast<std::uint32_t>(name.size());
+			out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+			out.write(name.data(), static_cast<std::streamsize>(name.size()));
+		}
+
+		const std::array<char, dataAlignment> padding{};
+		out.write(padding.data(), static_cast<std::streamsize>(header.dataOffset - sizeof(Header) - namesSize));
+
+		for (const auto& col : columns)
+			out.write(reinterpret_cast<const char*>(col.data()), static_cast<std::streamsize>(col.size_bytes()));
+
+		if (!out)
+			return false;
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tmpFilename, filename, ec);
+	if (ec)
+	{
+		std::filesystem::remove(tmpFilename, ec);
+		return false;
+	}
+	return true;
+}
+
+const std::vector<std::string>& PointCloudFile::columnNames() const
+{
+	return m_columnNames;
+}
+
+std::size_t PointCloudFile::rowCount() const
+{
+	return m_rowCount;
+}
+
+std::span<const float> PointCloudFile::column(std::size_t index) const
+{
+	const auto* data = reinterpret_cast<const float*>(m_file.data() + m_dataOffset);
+	return { data + index * m_rowCount, m_rowCount };
+}
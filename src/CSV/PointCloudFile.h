@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../MappedFile.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace molumes
+{
+	/**
+	 * @brief Memory-mapped binary point cloud (".mpc") that can be opened without a parse step.
+	 *
+	 * All values are little-endian:
+	 *
+	 *  | Offset | Size        | Content                                                              |
+	 *  |--------|-------------|----------------------------------------------------------------------|
+	 *  | 0      | 8           | magic "MOLPTCLD"                                                     |
+	 *  | 8      | 4           | uint32 format version (1)                                            |
+	 *  | 12     | 4           | uint32 column count C                                                |
+	 *  | 16     | 8           | uint64 row count N                                                   |
+	 *  | 24     | 8           | uint64 data offset D, a multiple of 64                               |
+	 *  | 32     | ...         | C column names, each a uint32 byte length followed by UTF-8 bytes    |
+	 *  | ...    | ...         | zero padding up to D                                                 |
+	 *  | D      | C * N * 4   | float32 values, stored column after column                           |
+	 *
+	 * The file size must be exactly D + C * N * 4.
+	 */
+	class PointCloudFile
+	{
+	public:
+		static constexpr const char* extension = ".mpc";
+
+		// maps the file and validates its header, returns std::nullopt if it is not a valid point cloud
+		static std::optional<PointCloudFile> open(const std::string& filename);
+
+		// writes the columns, which all need to have the same size, into a point cloud file
+		static bool write(const std::string& filename, const std::vector<std::string>& columnNames, const std::vector<std::span<const float>>& columns);
+
+		const std::vector<std::string>& columnNames() const;
+		std::size_t rowCount() const;
+
+		// view of a column directly in the mapped file
+		std::span<const float> column(std::size_t index) const;
+
+	private:
+		MappedFile m_file;
+		std::vector<std::string> m_columnNames;
+		std::size_t m_rowCount = 0;
+		std::uint64_t m_dataOffset = 0;
+	};
+}
@@ -1,36 +1,36 @@
 #pragma once
 
 #include "Table.h"
+#include "CSVParser.h"
 
 #include <string>
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
 #include <limits>
-#include <unordered_map>
-#include <string_view>
 
 using namespace molumes;
 using namespace glm;
 
-#ifdef HAVE_MATLAB
-#include <engine.h>
+namespace
+{
+	// CSV files at least this large are read in the background instead of blocking load()
+	constexpr std::uintmax_t streamingThreshold = 64 * 1024 * 1024;
 
-#endif
+	// rows per chunk handed from the background reader to the table
+	constexpr std::size_t streamChunkRowCount = 256 * 1024;
 
-auto stripSign(const std::string_view& str) {
-    return (str.starts_with('-') || str.starts_with('+')) ? str.substr(1) : str;
-}
+	// chunks the background reader may read ahead before it waits for pollStream()
+	constexpr std::size_t maxQueuedStreamChunks = 2;
 
-bool isInteger(const std::string_view& str) {
-    const auto& s = stripSign(str);
-    return std::all_of(s.begin(), s.end(), [](char c){ return std::isdigit(c); });
+	// CSV files with more columns than this are indexed and their columns only parsed once selected
+	constexpr std::size_t lazyColumnThreshold = 8;
 }
 
-bool isFloat(const std::string_view& str) {
-    auto separator = str.find_first_of(".,");
-    if (separator == std::string_view::npos)
-        return false;
+#ifdef HAVE_MATLAB
+#include <engine.h>
 
-    return isInteger(str.substr(0, separator)) && isInteger(str.substr(separator+1));
-}
+#endif
 
 Table::Table()
 {
@@ -44,7 +44,7 @@ const std::string & molumes::Table::filename() const
 
 Table::Table(const std::string& filename)
 {
-	load(m_filename);
+	load(filename);
 }
 
 const std::vector<std::string> Table::getColumnNames()
@@ -57,70 +57,375 @@ void Table::load(const std::string& filename)
 
 	m_filename = filename;
 
-	rapidcsv::Document loadedDocument(m_filename, rapidcsv::LabelParams(0, -1));
-	m_csvDocument = loadedDocument;
+	stopStreaming();
 
-	// get titles of all columns
-	m_columnNames = m_csvDocument.GetColumnNames();
-    std::erase_if(m_columnNames, [this](const auto& name){
-        const auto& col = m_csvDocument.GetColumn<std::string>(name);
-        return col.empty() || !isFloat(col.front()) && !isInteger(col.front());
-    });
-
-	// clear buffers if they already contain data ----------
-	m_activeXColumn.clear();
-	m_activeYColumn.clear();
-	//------------------------------------------------------
+	// reset active columns, they point into the previous table ----------
+	m_activeXColumn = {};
+	m_activeYColumn = {};
+	m_activeRadiusColumn = {};
+	m_activeColorColumn = {};
+	//--------------------------------------------------------------------
 
 	// clear table if it already contains data
+	m_columnNames.clear();
 	m_tableData.clear();
+	m_pointCloud.reset();
+	m_tableCache.reset();
+	m_csvIndex.reset();
+	m_columns.clear();
+
+	// binary point clouds are mapped and used as they are
+	if (std::filesystem::path{ m_filename }.extension() == PointCloudFile::extension)
+	{
+		if (!loadPointCloud())
+			std::cout << "Failed to open point cloud " << m_filename << std::endl;
+		return;
+	}
+
+	// use the columnar cache if it is still up to date with the CSV file, its columns are used in place
+	m_tableCache = TableCache::read(m_filename);
+	if (m_tableCache)
+	{
+		m_columnNames = m_tableCache->columnNames();
+		updateColumnViews();
+		computeColumnBounds();
+		return;
+	}
+
+	// only the header is read up front, so every path below scans the file once
+	const auto header = readCSVHeader(m_filename);
+	if (!header)
+	{
+		std::cout << "Failed to open " << m_filename << std::endl;
+		computeColumnBounds();
+		return;
+	}
+
+	// large files are streamed so the UI stays responsive while they are parsed
+	std::error_code ec;
+	if (std::filesystem::file_size(m_filename, ec) >= streamingThreshold && !ec)
+	{
+		startStreaming(*header);
+		return;
+	}
 
-	// fill table with column vectors
-	for (const auto& col : m_columnNames)
+	// wide files are indexed, only the columns that get selected are parsed
+	if (header->size() > lazyColumnThreshold)
 	{
-        m_tableData.push_back(m_csvDocument.GetColumn<float>(col));
+		if (auto index = CSVColumnIndex::open(m_filename))
+		{
+			m_csvIndex = std::move(index);
+			m_columnNames = m_csvIndex->columnNames();
+			m_tableData.assign(m_columnNames.size(), {});
+			updateColumnViews();
+			computeColumnBounds();
+			return;
+		}
 	}
+
+	// parse numeric columns of the CSV file, non-numeric columns are dropped
+	auto parsed = parseCSV(m_filename);
+	if (!parsed)
+	{
+		std::cout << "Failed to open " << m_filename << std::endl;
+		computeColumnBounds();
+		return;
+	}
+
+	m_columnNames = std::move(parsed->columnNames);
+	m_tableData = std::move(parsed->columns);
+	updateColumnViews();
+	computeColumnBounds();
+
+	TableCache::write(m_filename, m_columnNames, m_tableData);
 }
 
+bool Table::isTableFile(const std::string& filename)
+{
+	const auto extension = std::filesystem::path{ filename }.extension();
+	return extension == ".csv" || extension == PointCloudFile::extension;
+}
 
-const void  Table::updateBuffers(int xID, int yID, int radiusID, int colorID)
+bool Table::loadPointCloud()
 {
+	m_pointCloud = PointCloudFile::open(m_filename);
+	if (!m_pointCloud)
+	{
+		computeColumnBounds();
+		return false;
+	}
 
-	m_minimumBounds = vec3(std::numeric_limits<float>::max());
-	m_maximumBounds = vec3(-std::numeric_limits<float>::max());
+	m_columnNames = m_pointCloud->columnNames();
+	updateColumnViews();
+	computeColumnBounds();
+	return true;
+}
 
-	// clear active columns and prepare
-	m_activeXColumn.clear();
-	m_activeYColumn.clear();
-	m_activeRadiusColumn.clear();
-	m_activeColorColumn.clear();
+void Table::updateColumnViews()
+{
+	m_columns.clear();
+	if (m_pointCloud)
+	{
+		for (std::size_t i = 0; i < m_pointCloud->columnNames().size(); i++)
+			m_columns.push_back(m_pointCloud->column(i));
+	}
+	else if (m_tableCache)
+	{
+		for (std::size_t i = 0; i < m_tableCache->columnNames().size(); i++)
+			m_columns.push_back(m_tableCache->column(i));
+	}
+	else
+	{
+		for (const auto& col : m_tableData)
+			m_columns.emplace_back(col);
+	}
+}
 
-	m_activeTableData.clear();
+void Table::computeColumnBounds()
+{
+	m_columnMinimum.assign(m_columns.size(), 0.0f);
+	m_columnMaximum.assign(m_columns.size(), 0.0f);
 
-	//assign column vectors
-	m_activeXColumn = m_csvDocument.GetColumn<float>(m_columnNames[xID]);
-	m_activeYColumn = m_csvDocument.GetColumn<float>(m_columnNames[yID]);
-	m_activeRadiusColumn = m_csvDocument.GetColumn<float>(m_columnNames[radiusID]);
-	m_activeColorColumn = m_csvDocument.GetColumn<float>(m_columnNames[colorID]);
+	for (std::size_t i = 0; i < m_columns.size(); i++)
+		computeColumnBounds(i);
+}
 
-	std::vector<vec4> tableEntries;
+void Table::computeColumnBounds(std::size_t column)
+{
+	if (m_columns[column].empty())
+		return;
+
+	const auto [minIt, maxIt] = std::minmax_element(m_columns[column].begin(), m_columns[column].end());
+	m_columnMinimum[column] = *minIt;
+	m_columnMaximum[column] = *maxIt;
+}
+
+bool Table::ensureColumnParsed(int column)
+{
+	if (!m_csvIndex || column < 0 || column >= static_cast<int>(m_tableData.size()) || !m_tableData[column].empty())
+		return true;
 
-	// update bounding volume 
-	for (int i = 0; i < m_tableData[0].size(); i++)
+	auto values = m_csvIndex->parseColumn(column);
+	if (!values)
 	{
+		// like parseCSV(), a column with a non-numeric cell is dropped
+		std::cout << "Column " << m_columnNames[column] << " of " << m_filename << " is not numeric and was dropped" << std::endl;
+		m_csvIndex->dropColumn(column);
+		dropColumns({ static_cast<std::size_t>(column) });
+		updateColumnViews();
+		return false;
+	}
+
+	m_tableData[column] = std::move(*values);
+	m_columns[column] = m_tableData[column];
+	computeColumnBounds(column);
+	return true;
+}
+
+
+void Table::startStreaming(const std::vector<std::string>& columnNames)
+{
+	// counting the rows and finding the numeric columns scans the file, so both happen on the reader thread as well
+	m_columnNames = columnNames;
+	m_expectedRowCount = 0;
+	m_tableData.assign(m_columnNames.size(), {});
+	updateColumnViews();
+
+	m_columnMinimum.assign(m_columnNames.size(), std::numeric_limits<float>::max());
+	m_columnMaximum.assign(m_columnNames.size(), std::numeric_limits<float>::lowest());
+
+	m_streamFinished = false;
+	m_streamAppended = false;
+	m_streaming = true;
+
+	m_streamThread = std::jthread{ [this, filename = m_filename](std::stop_token stopToken) {
+		auto reader = CSVStreamReader::open(filename, streamChunkRowCount);
+		if (!reader)
+			std::cout << "Failed to open " << filename << std::endl;
+
+		StreamChunk chunk;
+		chunk.expectedRowCount = reader ? reader->rowCount() : 0;
+		while (reader && !stopToken.stop_requested() && reader->read(chunk.columns, chunk.droppedColumns))
+		{
+			std::unique_lock lock{ m_streamMutex };
+
+			// bound memory use by the number of chunks waiting to be appended
+			if (!m_streamCondition.wait(lock, stopToken, [this]() { return m_streamChunks.size() < maxQueuedStreamChunks; }))
+				return;
+
+			m_streamChunks.push_back(std::move(chunk));
+			chunk = {};
+		}
+
+		std::unique_lock lock{ m_streamMutex };
+		m_streamFinished = true;
+		if (!reader || stopToken.stop_requested())
+			return;
+
+		// the table is complete and no longer modified once pollStream() appended the last chunk
+		if (!m_streamCondition.wait(lock, stopToken, [this]() { return m_streamAppended; }))
+			return;
+		lock.unlock();
+
+		TableCache::write(filename, m_columnNames, m_tableData, stopToken);
+	} };
+}
+
+void Table::stopStreaming()
+{
+	// requests stop and joins the reader
+	m_streamThread = {};
+	m_streamChunks.clear();
+	m_streaming = false;
+}
+
+Table::RowRange Table::pollStream()
+{
+	RowRange appended{ m_columns.empty() ? 0 : m_columns.front().size(), 0 };
+	if (!m_streaming)
+		return appended;
+
+	std::deque<StreamChunk> chunks;
+	bool finished;
+	{
+		std::scoped_lock lock{ m_streamMutex };
+		chunks.swap(m_streamChunks);
+		finished = m_streamFinished;
+	}
+	m_streamCondition.notify_all();
+
+	for (const auto& chunk : chunks)
+	{
+		// like parseCSV(), columns with a non-numeric cell are dropped completely
+		if (!chunk.droppedColumns.empty())
+		{
+			dropColumns(chunk.droppedColumns);
+			appended.columnsChanged = true;
+		}
+
+		// reserve the final size once it is known, so appending chunks never reallocates
+		if (chunk.expectedRowCount)
+		{
+			m_expectedRowCount = *chunk.expectedRowCount;
+			for (auto& col : m_tableData)
+				col.reserve(m_expectedRowCount);
+			appended.columnsChanged = true;
+		}
+
+		for (std::size_t i = 0; i < chunk.columns.size() && i < m_tableData.size(); i++)
+		{
+			const auto& column = chunk.columns[i];
+			m_tableData[i].insert(m_tableData[i].end(), column.begin(), column.end());
+
+			const auto [minIt, maxIt] = std::minmax_element(column.begin(), column.end());
+			if (minIt != column.end())
+			{
+				m_columnMinimum[i] = std::min(m_columnMinimum[i], *minIt);
+				m_columnMaximum[i] = std::max(m_columnMaximum[i], *maxIt);
+			}
+		}
+
+		if (!chunk.columns.empty())
+			appended.count += chunk.columns.front().size();
+	}
+
+	// every chunk is appended, the reader writes the table cache in the background and stops
+	if (finished)
+	{
+		{
+			std::scoped_lock lock{ m_streamMutex };
+			m_streamAppended = true;
+		}
+		m_streamCondition.notify_all();
+		m_streaming = false;
+	}
+
+	// point active columns at the grown table
+	if (appended.count > 0 || appended.columnsChanged)
+	{
+		updateColumnViews();
+		updateBuffers(m_activeIDs[0], m_activeIDs[1], m_activeIDs[2], m_activeIDs[3]);
+	}
 
-		// fill atom vector
-		vec4 entry = vec4(m_activeXColumn[i], m_activeYColumn[i], m_activeRadiusColumn[i], m_activeColorColumn[i]);
-		tableEntries.push_back(entry);
+	return appended;
+}
 
-		// update bounding volume depending on X and Y values
-		m_minimumBounds = min(m_minimumBounds, vec3(entry));
-		m_maximumBounds = max(m_maximumBounds, vec3(entry));
+void Table::dropColumns(const std::vector<std::size_t>& columns)
+{
+	// from the back, so the indices of the columns still to be dropped stay valid
+	for (auto column = columns.rbegin(); column != columns.rend(); ++column)
+	{
+		const auto offset = static_cast<std::ptrdiff_t>(*column);
+		m_columnNames.erase(m_columnNames.begin() + offset);
+		m_tableData.erase(m_tableData.begin() + offset);
+		m_columnMinimum.erase(m_columnMinimum.begin() + offset);
+		m_columnMaximum.erase(m_columnMaximum.begin() + offset);
+	}
 
+	// deselect dropped columns and move the IDs of the columns after them down
+	for (auto& id : m_activeIDs)
+	{
+		if (id < 0)
+			continue;
+		const auto index = static_cast<std::size_t>(id);
+		if (std::binary_search(columns.begin(), columns.end(), index))
+			id = -1;
+		else
+			id -= static_cast<int>(std::lower_bound(columns.begin(), columns.end(), index) - columns.begin());
 	}
+}
 
-	m_activeTableData.push_back(tableEntries);
+bool Table::isStreaming() const
+{
+	return m_streaming;
+}
 
+std::size_t Table::expectedRowCount() const
+{
+	if (m_streaming)
+		return m_expectedRowCount;
+	return m_columns.empty() ? 0 : m_columns.front().size();
+}
+
+
+bool Table::updateBuffers(int xID, int yID, int radiusID, int colorID)
+{
+	m_activeIDs = { xID, yID, radiusID, colorID };
+
+	// columns of indexed files are parsed on first use, dropping a non-numeric one updates m_activeIDs
+	bool columnsKept = true;
+	for (std::size_t i = 0; i < m_activeIDs.size(); i++)
+	{
+		if (!ensureColumnParsed(m_activeIDs[i]))
+			columnsKept = false;
+	}
+	xID = m_activeIDs[0];
+	yID = m_activeIDs[1];
+	radiusID = m_activeIDs[2];
+	colorID = m_activeIDs[3];
+
+	const auto validID = [this](int id) { return 0 <= id && id < static_cast<int>(m_columns.size()); };
+	const auto hasRows = [&](int id) { return validID(id) && !m_columns[id].empty(); };
+	const auto column = [&](int id) { return validID(id) ? m_columns[id] : std::span<const float>{}; };
+	const auto minimum = [&](int id) { return hasRows(id) ? m_columnMinimum[id] : 0.0f; };
+	const auto maximum = [&](int id) { return hasRows(id) ? m_columnMaximum[id] : 0.0f; };
+
+	// assign column views
+	m_activeXColumn = column(xID);
+	m_activeYColumn = column(yID);
+	m_activeRadiusColumn = column(radiusID);
+	m_activeColorColumn = column(colorID);
+
+	// update bounding volume depending on X, Y and radius values
+	m_minimumBounds = vec3(minimum(xID), minimum(yID), minimum(radiusID));
+	m_maximumBounds = vec3(maximum(xID), maximum(yID), maximum(radiusID));
+
+	return columnsKept;
+}
+
+std::size_t Table::activeRowCount() const
+{
+	return m_activeXColumn.size();
 }
 
 vec3 Table::minimumBounds() const
@@ -133,27 +438,22 @@ vec3 Table::maximumBounds() const
 	return m_maximumBounds;
 }
 
-const std::vector< std::vector<glm::vec4> > & Table::activeTableData() const
-{
-	return m_activeTableData;
-}
-
-const std::vector<float>& Table::activeXColumn() const
+std::span<const float> Table::activeXColumn() const
 {
 	return m_activeXColumn;
 }
 
-const std::vector<float>& Table::activeYColumn() const
+std::span<const float> Table::activeYColumn() const
 {
 	return m_activeYColumn;
 }
 
-const std::vector<float>& Table::activeRadiusColumn() const
+std::span<const float> Table::activeRadiusColumn() const
 {
 	return m_activeRadiusColumn;
 }
 
-const std::vector<float>& Table::activeColorColumn() const
+std::span<const float> Table::activeColorColumn() const
 {
 	return m_activeColorColumn;
 }
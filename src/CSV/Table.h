@@ -1,11 +1,19 @@
 #pragma once
 
+#include "CSVParser.h"
+#include "PointCloudFile.h"
+#include "TableCache.h"
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
 #include <vector>
 #include <glm/glm.hpp>
 
-// header to process CSV
-#include "rapidcsv.h"
-
 
 namespace molumes
 {
@@ -14,55 +22,124 @@ namespace molumes
 
 	public:
 
+		// range of rows appended to the table by pollStream()
+		struct RowRange
+		{
+			std::size_t first = 0;
+			std::size_t count = 0;
+			// the first chunk set the row count and the numeric columns, or columns that turned out to be non-numeric
+			// were dropped (column IDs after them moved down)
+			bool columnsChanged = false;
+		};
+
 		Table();
 		Table(const std::string& filename);
 		void load(const std::string& filename);
 
+		// whether load() can read the file (CSV or binary point cloud)
+		static bool isTableFile(const std::string& filename);
+
 		// file properties
 		const std::string & filename() const;
 		const std::vector<std::string> getColumnNames();
 
 		// handling buffers (IDs depend on column namens accessed using the GUI)
-		const void updateBuffers(int xID, int yID, int radiusID, int colorID);
+		// returns false if a selected column of an indexed file turned out to be non-numeric and was dropped, so the
+		// column IDs after it moved down
+		bool updateBuffers(int xID, int yID, int radiusID, int colorID);
 
-		// access complete currently active table
-		const std::vector < std::vector<glm::vec4> > & activeTableData() const;
+		// number of rows in the currently active columns (0 until updateBuffers() was called)
+		std::size_t activeRowCount() const;
 
-		// access individual currently active data columns
-		const std::vector<float> & activeXColumn() const;
-		const std::vector<float> & activeYColumn() const;
-		const std::vector<float> & activeRadiusColumn() const;
-		const std::vector<float> & activeColorColumn() const;
+		// access individual currently active data columns (views into the loaded table)
+		std::span<const float> activeXColumn() const;
+		std::span<const float> activeYColumn() const;
+		std::span<const float> activeRadiusColumn() const;
+		std::span<const float> activeColorColumn() const;
 
 		// access current bounding volume
 		glm::vec3 minimumBounds() const;
 		glm::vec3 maximumBounds() const;
 
+		// streaming: large files are read in chunks on a background thread after load() returned. Until the first
+		// chunk arrived, the table has every column of the header and no rows
+		bool isStreaming() const;
+		// number of rows the table will contain once streaming has finished (0 until the first chunk arrived)
+		std::size_t expectedRowCount() const;
+		// append rows read in the background to the table and update active columns and bounds accordingly
+		RowRange pollStream();
+
 	private:
 
 		std::string m_filename;
 
-		// CSV file
-		rapidcsv::Document m_csvDocument;
-
 		// stored names of column-headers
 		std::vector<std::string> m_columnNames;
 
-		// complete table stored as vector of row vectors
+		// complete table stored as vector of column vectors (empty for memory-mapped point clouds and caches)
 		std::vector<std::vector<float>> m_tableData;
 
-		// currently active table
-		std::vector<std::vector<glm::vec4> > m_activeTableData;
+		// memory-mapped binary point cloud, if one was loaded
+		std::optional<PointCloudFile> m_pointCloud;
 
-		// current CSV data vectors that are used to fill VBOs
-		std::vector<float> m_activeXColumn;
-		std::vector<float> m_activeYColumn;
-		std::vector<float> m_activeRadiusColumn;
-		std::vector<float> m_activeColorColumn;
+		// memory-mapped table cache of the CSV file, if it was up to date
+		std::optional<TableCache> m_tableCache;
+
+		// views of every column, either into m_tableData or into the mapped point cloud or cache
+		std::vector<std::span<const float>> m_columns;
+
+		// row index of a wide CSV file whose columns are only parsed once they are selected
+		std::optional<CSVColumnIndex> m_csvIndex;
+
+		// minimum and maximum value of every column, computed once at load
+		std::vector<float> m_columnMinimum;
+		std::vector<float> m_columnMaximum;
+
+		// currently active data columns that are used to fill VBOs
+		std::span<const float> m_activeXColumn;
+		std::span<const float> m_activeYColumn;
+		std::span<const float> m_activeRadiusColumn;
+		std::span<const float> m_activeColorColumn;
 
 		// bounding box of current selection
 		glm::vec3 m_minimumBounds = glm::vec3(0.0);
 		glm::vec3 m_maximumBounds = glm::vec3(0.0);
-		
+
+		// column IDs of the current selection
+		std::array<int, 4> m_activeIDs = { -1, -1, -1, -1 };
+
+		// streaming state ----------
+		bool m_streaming = false;
+		std::size_t m_expectedRowCount = 0;
+
+		// rows read by the background reader, and the columns it dropped before them (indices before the drop)
+		struct StreamChunk
+		{
+			std::vector<std::vector<float>> columns;
+			std::vector<std::size_t> droppedColumns;
+			// row count of the file, counted by the reader before the first chunk
+			std::optional<std::size_t> expectedRowCount;
+		};
+
+		// shared with the background reader, guarded by m_streamMutex
+		std::mutex m_streamMutex;
+		std::condition_variable_any m_streamCondition;
+		std::deque<StreamChunk> m_streamChunks;
+		bool m_streamFinished = false;
+		// set once pollStream() appended the last chunk, the reader then writes the table cache from the table
+		bool m_streamAppended = false;
+
+		// declared last so the reader is stopped before the state it uses is destroyed
+		std::jthread m_streamThread;
+		//---------------------------
+
+		void updateColumnViews();
+		void computeColumnBounds();
+		void computeColumnBounds(std::size_t column);
+		bool ensureColumnParsed(int column);
+		bool loadPointCloud();
+		void startStreaming(const std::vector<std::string>& columnNames);
+		void stopStreaming();
+		void dropColumns(const std::vector<std::size_t>& columns);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,220 @@
+#include "TableCache.h"
+#include "../MappedFile.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+using namespace molumes;
+
+namespace
+{
+	constexpr std::array<char, 8> cacheMagic{ 'M', 'O', 'L', 'T', 'B', 'L', 'C', 'A' };
+	constexpr std::uint32_t cacheVersion = 2;
+	constexpr std::uint64_t dataAlignment = 64;
+
+	// amount of bytes hashed at the start and the end of the source file
+	constexpr std::size_t hashSampleSize = 64 * 1024;
+
+	struct Header
+	{
+		std::array<char, 8> magic;
+		std::uint32_t version;
+		std::uint32_t columnCount;
+		std::uint64_t rowCount;
+		std::uint64_t sourceSize;
+		std::int64_t sourceModificationTime;
+		std::uint64_t sourceHash;
+		std::uint64_t dataOffset;
+	};
+
+	struct SourceStamp
+	{
+		std::uint64_t size = 0;
+		std::int64_t modificationTime = 0;
+		std::uint64_t hash = 0;
+
+		bool operator==(const SourceStamp&) const = default;
+	};
+
+	std::uint64_t fnv1a(const std::byte* data, std::size_t size, std::uint64_t hash = 14695981039346656037ull)
+	{
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			hash ^= static_cast<std::uint64_t>(data[i]);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// Size and modification time of the source plus a hash over its first and last bytes. Hashing the whole file
+	// would cost nearly as much I/O as the parse the cache is meant to avoid.
+	std::optional<SourceStamp> stampSource(const std::string& sourceFilename)
+	{
+		std::error_code ec;
+		const auto size = std::filesystem::file_size(sourceFilename, ec);
+		if (ec)
+			return std::nullopt;
+		const auto modificationTime = std::filesystem::last_write_time(sourceFilename, ec);
+		if (ec)
+			return std::nullopt;
+
+		const auto source = MappedFile::open(sourceFilename);
+		if (!source)
+			return std::nullopt;
+
+		const auto head = std::min(source->size(), hashSampleSize);
+		const auto tailStart = std::max(head, source->size() - std::min(source->size(), hashSampleSize));
+		auto hash = fnv1a(source->data(), head);
+		hash = fnv1a(source->data() + tailStart, source->size() - tailStart, hash);
+
+		return SourceStamp{ static_cast<std::uint64_t>(size),
+			static_cast<std::int64_t>(modificationTime.time_since_epoch().count()), hash };
+	}
+}
+
+std::string TableCache::cachePath(const std::string& sourceFilename)
+{
+	return sourceFilename + ".tblcache";
+}
+
+std::optional<TableCache> TableCache::read(const std::string& sourceFilename)
+{
+	const auto stamp = stampSource(sourceFilename);
+	if (!stamp)
+		return std::nullopt;
+
+	auto file = MappedFile::open(cachePath(sourceFilename));
+	if (!file || file->size() < sizeof(Header))
+		return std::nullopt;
+
+	Header header;
+	std::memcpy(&header, file->data(), sizeof(Header));
+	// the columns are used in place, so the data needs to be aligned for floats
+	if (header.magic != cacheMagic || header.version != cacheVersion || header.dataOffset % dataAlignment != 0)
+		return std::nullopt;
+
+	if (SourceStamp{ header.sourceSize, header.sourceModificationTime, header.sourceHash } != *stamp)
+		return std::nullopt;
+
+	const auto dataSize = std::uint64_t{ header.columnCount } * header.rowCount * sizeof(float);
+	if (header.dataOffset > file->size() || file->size() - header.dataOffset != dataSize)
+		return std::nullopt;
+
+	TableCache cache;
+	cache.m_columnNames.reserve(header.columnCount);
+
+	// column names
+	std::size_t offset = sizeof(Header);
+	for (std::uint32_t i = 0; i < header.columnCount; ++i)
+	{
+		std::uint32_t length;
+		if (offset + sizeof(length) > header.dataOffset)
+			return std::nullopt;
+		std::memcpy(&length, file->data() + offset, sizeof(length));
+		offset += sizeof(length);
+
+		if (offset + length > header.dataOffset)
+			return std::nullopt;
+		cache.m_columnNames.emplace_back(reinterpret_cast<const char*>(file->data() + offset), length);
+		offset += length;
+	}
+
+	cache.m_rowCount = header.rowCount;
+	cache.m_dataOffset = header.dataOffset;
+	cache.m_file = std::move(*file);
+	return cache;
+}
+
+bool TableCache::write(const std::string& sourceFilename, const std::vector<std::string>& columnNames, const std::vector<std::vector<float>>& columns, std::stop_token stopToken)
+{
+	const auto stamp = stampSource(sourceFilename);
+	if (!stamp || columnNames.size() != columns.size())
+		return false;
+
+	const std::uint64_t rowCount = columns.empty() ? 0 : columns.front().size();
+	if (std::any_of(columns.begin(), columns.end(), [rowCount](const auto& col) { return col.size() != rowCount; }))
+		return false;
+
+	std::uint64_t namesSize = 0;
+	for (const auto& name : columnNames)
+		namesSize += sizeof(std::uint32_t) + name.size();
+
+	Header header{};
+	header.magic = cacheMagic;
+	header.version = cacheVersion;
+	header.columnCount = static_cast<std::uint32_t>(columns.size());
+	header.rowCount = rowCount;
+	header.sourceSize = stamp->size;
+	header.sourceModificationTime = stamp->modificationTime;
+	header.sourceHash = stamp->hash;
+	header.dataOffset = (sizeof(Header) + namesSize + dataAlignment - 1) / dataAlignment * dataAlignment;
+
+	// write to a temporary file first so an interrupted write never leaves a valid-looking cache behind
+	const auto path = cachePath(sourceFilename);
+	const auto tmpPath = path + ".tmp";
+	{
+		std::ofstream out{ tmpPath, std::ios::binary | std::ios::trunc };
+		if (!out)
+			return false;
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		for (const auto& name : columnNames)
+		{
+			const auto length = static_cast<std::uint32_t>(name.size());
+			out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+			out.write(name.data(), static_cast<std::streamsize>(name.size()));
+		}
+
+		const std::array<char, dataAlignment> padding{};
+		out.write(padding.data(), static_cast<std::streamsize>(header.dataOffset - sizeof(Header) - namesSize));
+
+		for (const auto& col : columns)
+		{
+			if (stopToken.stop_requested())
+				break;
+			out.write(reinterpret_cast<const char*>(col.data()), static_cast<std::streamsize>(col.size() * sizeof(float)));
+		}
+
+		if (stopToken.stop_requested())
+		{
+			out.close();
+			std::error_code ec;
+			std::filesystem::remove(tmpPath, ec);
+			return false;
+		}
+		if (!out)
+		{
+			std::cout << "Failed to write table cache " << path << std::endl;
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tmpPath, path, ec);
+	if (ec)
+	{
+		std::filesystem::remove(tmpPath, ec);
+		return false;
+	}
+	return true;
+}
+
+const std::vector<std::string>& TableCache::columnNames() const
+{
+	return m_columnNames;
+}
+
+std::size_t TableCache::rowCount() const
+{
+	return m_rowCount;
+}
+
+std::span<const float> TableCache::column(std::size_t index) const
+{
+	const auto* data = reinterpret_cast<const float*>(m_file.data() + m_dataOffset);
+	return { data + index * m_rowCount, m_rowCount };
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../MappedFile.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+namespace molumes
+{
+	/**
+	 * @brief Columnar binary sidecar cache for parsed CSV tables.
+	 *
+	 * The cache is stored next to the source file as "<file>.tblcache" and holds the numeric column names and
+	 * every column as float32. It is only used when the size, modification time and sampled content hash of the
+	 * source still match the ones recorded in the cache header.
+	 *
+	 * Layout (native endianness):
+	 *  - Header (see TableCache.cpp)
+	 *  - columnCount names, each as uint32 byte length followed by the characters
+	 *  - padding up to Header::dataOffset
+	 *  - columnCount * rowCount float32 values, stored column by column
+	 *
+	 * A cache that was read keeps the file mapped, and its columns are views into the mapping, like PointCloudFile.
+	 */
+	class TableCache
+	{
+	public:
+		// path of the sidecar cache belonging to a source file
+		static std::string cachePath(const std::string& sourceFilename);
+
+		// memory-maps the cache, or returns std::nullopt if it is missing, stale or corrupt
+		static std::optional<TableCache> read(const std::string& sourceFilename);
+
+		// writes a cache for the source file. Returns false if the cache could not be written or stop was requested
+		static bool write(const std::string& sourceFilename, const std::vector<std::string>& columnNames, const std::vector<std::vector<float>>& columns, std::stop_token stopToken = {});
+
+		const std::vector<std::string>& columnNames() const;
+		std::size_t rowCount() const;
+
+		// view of a column directly in the mapped cache
+		std::span<const float> column(std::size_t index) const;
+
+	private:
+		MappedFile m_file;
+		std::vector<std::string> m_columnNames;
+		std::size_t m_rowCount = 0;
+		std::uint64_t m_dataOffset = 0;
+	};
+}
@@ -7,6 +7,7 @@
 #include <memory>
 #include <tuple>
 #include <array>
+#include <atomic>
 
 /**
  * Go/Rust inspired method of handling direct data transfer between threads
@@ -115,7 +116,8 @@ class ChannelBase {
 protected:
     struct SharedBlock {
         std::array<T, BufferCount> data;
-        std::size_t index{BufferCount - 1};
+        // Atomic so readers can check for updates without locking, the buffers themselves aren't synchronized
+        std::atomic<std::size_t> index{BufferCount - 1};
         std::mutex mutex;
     };
     std::shared_ptr<SharedBlock> m_shared;
@@ -156,9 +158,11 @@ public:
      * Checks if the reader has new information (if the pointed to index is different from the last read one)
      * False is not a guarantee that there's no updated information, but true is guaranteed to yield new information
      */
-    [[nodiscard]] bool has_update() const { return m_cached_index != this->m_shared->index; }
+    [[nodiscard]] bool has_update() const {
+        return m_cached_index != this->m_shared->index.load(std::memory_order_acquire);
+    }
     T get() {
-        m_cached_index = this->m_shared->index;
+        m_cached_index = this->m_shared->index.load(std::memory_order_acquire);
         return this->m_shared->data.at(m_cached_index);
     }
 };
@@ -183,9 +187,9 @@ public:
     // No synchronization needed
     void write(const T &data) {
         std::lock_guard lock{this->m_shared->mutex};
-        std::size_t next_index = (this->m_shared->index + 1) % this->buffer_count;
+        std::size_t next_index = (this->m_shared->index.load(std::memory_order_relaxed) + 1) % this->buffer_count;
         this->m_shared->data.at(next_index) = data;
-        this->m_shared->index = next_index;
+        this->m_shared->index.store(next_index, std::memory_order_release);
     }
 };
 
@@ -0,0 +1,114 @@
+#ifndef MOLUMES_FIXEDRATESCHEDULER_H
+#define MOLUMES_FIXEDRATESCHEDULER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <thread>
+
+namespace molumes {
+    /**
+     * @brief Paces a loop to a fixed rate and records how far the actual loop periods deviate from it
+     *
+     * wait() sleeps until shortly before the next deadline and spins the rest of the way, since a plain sleep can
+     * overshoot by much more than a haptic period (especially on Windows). Deadlines are absolute, so a late tick
+     * doesn't shift the following ones. If the loop falls behind by more than a whole period the missed deadlines are
+     * dropped and counted as overruns instead of running a burst of catch-up ticks.
+     */
+    class FixedRateScheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // Loop period statistics since the last reset, in microseconds
+        struct Statistics {
+            double target_period_us{0.0};
+            double mean_period_us{0.0};
+            double min_period_us{0.0};
+            double max_period_us{0.0};
+            double jitter_us{0.0}; // Standard deviation of the period
+            std::uint64_t ticks{0};
+            std::uint64_t overruns{0};
+        };
+
+    private:
+        Clock::duration m_period;
+        Clock::duration m_spin_threshold;
+        Clock::time_point m_deadline{};
+        Clock::time_point m_last_wakeup{};
+
+        std::uint64_t m_ticks{0}, m_overruns{0};
+        double m_sum_us{0.0}, m_sum_squared_us{0.0};
+        double m_min_us{std::numeric_limits<double>::max()}, m_max_us{0.0};
+
+    public:
+        explicit FixedRateScheduler(double rate_hz, Clock::duration spin_threshold = std::chrono::microseconds{200})
+                : m_period{period_from_rate(rate_hz)}, m_spin_threshold{spin_threshold} {}
+
+        static Clock::duration period_from_rate(double rate_hz) {
+            return std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>{1.0 / std::max(rate_hz, 1.0)});
+        }
+
+        void set_rate(double rate_hz) { m_period = period_from_rate(rate_hz); }
+
+        Clock::duration period() const { return m_period; }
+
+        /// Blocks until the next tick is due and returns the time the tick started
+        Clock::time_point wait() {
+            if (m_deadline == Clock::time_point{}) {
+                // First tick starts immediately
+                m_last_wakeup = Clock::now();
+                m_deadline = m_last_wakeup + m_period;
+                return m_last_wakeup;
+            }
+
+            if (const auto remaining = m_deadline - Clock::now(); m_spin_threshold < remaining)
+                std::this_thread::sleep_for(remaining - m_spin_threshold);
+            auto now = Clock::now();
+            while (now < m_deadline) {
+                std::this_thread::yield();
+                now = Clock::now();
+            }
+
+            const auto period_us = std::chrono::duration<double, std::micro>{now - m_last_wakeup}.count();
+            m_last_wakeup = now;
+            ++m_ticks;
+            m_sum_us += period_us;
+            m_sum_squared_us += period_us * period_us;
+            m_min_us = std::min(m_min_us, period_us);
+            m_max_us = std::max(m_max_us, period_us);
+
+            m_deadline += m_period;
+            if (m_deadline <= now) {
+                m_overruns += static_cast<std::uint64_t>((now - m_deadline) / m_period) + 1;
+                m_deadline = now + m_period;
+            }
+            return now;
+        }
+
+        Statistics statistics() const {
+            Statistics stats{.target_period_us = std::chrono::duration<double, std::micro>{m_period}.count(),
+                             .ticks = m_ticks, .overruns = m_overruns};
+            if (m_ticks == 0)
+                return stats;
+
+            const auto n = static_cast<double>(m_ticks);
+            stats.mean_period_us = m_sum_us / n;
+            stats.min_period_us = m_min_us;
+            stats.max_period_us = m_max_us;
+            stats.jitter_us = std::sqrt(std::max(m_sum_squared_us / n - stats.mean_period_us * stats.mean_period_us,
+                                                 0.0));
+            return stats;
+        }
+
+        void reset_statistics() {
+            m_ticks = m_overruns = 0;
+            m_sum_us = m_sum_squared_us = m_max_us = 0.0;
+            m_min_us = std::numeric_limits<double>::max();
+        }
+    };
+}
+
+#endif //MOLUMES_FIXEDRATESCHEDULER_H
@@ -1,12 +1,14 @@
 #include "GeometryUtils.h"
 
-#include <deque>
-#include <tuple>
+#include <array>
+#include <numeric>
 #include <iostream>
 #include <utility>
-#include <map>
+#include <cstdint>
+#include <cmath>
 
 #include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
 
 #include <globjects/Buffer.h>
 
@@ -24,215 +26,397 @@ namespace molumes {
         return epsilon <= scalarCross2D(a, b);
     }
 
-    double dotBetween(const dvec2 &a, const dvec2 &b) {
-        // -0.25 * [1,-1] + 0.25 -> [0,0.5]
-        // 0.25 * [-1,1] + 0.75 -> [0.5,1]
-        return ccw(a, b) ? (-0.25 * dot(a, b) + 0.25) : (0.25 * dot(a, b) + 0.75);
+    // Hexagon centers used for the convex hull, stored as separate arrays
+    struct HexagonCenters {
+        std::vector<double> x, y;
+        // index of every hexagon in the hexagon center list
+        std::vector<unsigned int> hexIndices;
+
+        std::size_t size() const { return x.size(); }
+
+        dvec2 at(std::size_t i) const { return {x[i], y[i]}; }
+    };
+
+    /**
+     * Akl-Toussaint heuristic: the points that are extreme along the axes and diagonals span an octagon inside of
+     * the hull, so every point strictly inside of the octagon can be removed before building the hull.
+     */
+    HexagonCenters removeInteriorPoints(const HexagonCenters &centers) {
+        const auto at = [&centers](std::size_t j) { return centers.at(j); };
+        std::array<std::size_t, 8> extremes{};
+        for (std::size_t i{1}; i < centers.size(); ++i) {
+            const auto x = centers.x[i], y = centers.y[i];
+            // Counter-clockwise: bottom, bottom right, right, top right, top, top left, left, bottom left
+            if (y < at(extremes[0]).y) extremes[0] = i;
+            if (at(extremes[1]).x - at(extremes[1]).y < x - y) extremes[1] = i;
+            if (at(extremes[2]).x < x) extremes[2] = i;
+            if (at(extremes[3]).x + at(extremes[3]).y < x + y) extremes[3] = i;
+            if (at(extremes[4]).y < y) extremes[4] = i;
+            if (x - y < at(extremes[5]).x - at(extremes[5]).y) extremes[5] = i;
+            if (x < at(extremes[6]).x) extremes[6] = i;
+            if (x + y < at(extremes[7]).x + at(extremes[7]).y) extremes[7] = i;
+        }
+
+        // Octagon edges, extreme points that coincide give empty edges which are skipped
+        std::vector<std::pair<dvec2, dvec2>> edges;
+        for (std::size_t e{0}; e < extremes.size(); ++e) {
+            const auto a = centers.at(extremes[e]);
+            const auto b = centers.at(extremes[(e + 1) % extremes.size()]);
+            if (EPS < length(b - a))
+                edges.emplace_back(a, b - a);
+        }
+        if (edges.empty())
+            return centers;
+
+        const auto pointCount = static_cast<std::int64_t>(centers.size());
+        std::vector<char> keep(centers.size());
+#pragma omp parallel for schedule(static)
+        for (std::int64_t i = 0; i < pointCount; ++i) {
+            const auto p = centers.at(i);
+            keep[i] = std::any_of(edges.begin(), edges.end(), [&p](const auto &edge) {
+                return !ccw(edge.second, p - edge.first, EPS);
+            });
+        }
+
+        HexagonCenters candidates;
+        for (std::size_t i{0}; i < centers.size(); ++i) {
+            if (keep[i]) {
+                candidates.x.push_back(centers.x[i]);
+                candidates.y.push_back(centers.y[i]);
+                candidates.hexIndices.push_back(centers.hexIndices[i]);
+            }
+        }
+        return candidates;
     }
 
-    auto getHexagonPositions(const std::vector<vec4> &vertices) {
-        constexpr auto stride = 3u * 6u * 2u;
-        std::vector<std::pair<vec4, unsigned int>> centers;
-        centers.reserve(vertices.size() / stride);
-        // hexID * 3 * 6 * 2
-        // First vertex in every stride offset is the center
-        for (uint i{0}; i < vertices.size(); i += stride)
-            centers.emplace_back(vertices.at(i), i);
-        return centers;
+    // Welding grid cells are a few tolerances wide. Only vertices closer than the tolerance to a border of their cell
+    // have to search the neighbouring cell across that border as well.
+    constexpr float weldCellsPerTolerance = 8.f;
+
+    struct WeldCell {
+        ivec3 cell;
+        // -1, 0 or 1 for every axis, the direction of the neighbouring cell that has to be searched as well
+        ivec3 side;
+    };
+
+    // Open addressing hash table slot, head is the first unique vertex inside of the cell or -1 for empty slots
+    struct WeldSlot {
+        ivec3 cell;
+        int head = -1;
+    };
+
+    std::size_t hashCell(const ivec3 &c) {
+        auto h = static_cast<uint64_t>(static_cast<uint32_t>(c.x));
+        h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(c.y);
+        h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(c.z);
+        h *= 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(h ^ (h >> 32));
     }
 
-    template<typename T, int N>
-    std::weak_ordering
-    compareVec(const vec<N, T> &as, const vec<N, T> &bs, unsigned int i = 0, float epsilon = 0.0001f) {
-        return N <= i ? std::weak_ordering::equivalent : (as[i] < bs[i] + epsilon && bs[i] < as[i] + epsilon) ?
-                                                         compareVec(as, bs, i + 1, epsilon) :
-                                                         ((as[i] < bs[i]) ? std::weak_ordering::less
-                                                                          : std::weak_ordering::greater);
+    std::size_t findSlot(const std::vector<WeldSlot> &slots, const ivec3 &c) {
+        const auto mask = slots.size() - 1;
+        auto slot = hashCell(c) & mask;
+        while (slots[slot].head != -1 && slots[slot].cell != c)
+            slot = (slot + 1) & mask;
+        return slot;
     }
 
-    struct vec4_comparator {
-        auto operator()(const vec4 &lhs, const vec4 &rhs) const {
-            return compareVec(lhs, rhs) == std::weak_ordering::less;
+    std::pair<std::vector<vec4>, std::vector<unsigned int>>
+    getVertexIndexPairs(const std::vector<vec4> &vertices, float tolerance) {
+        const auto vertexCount = static_cast<std::int64_t>(vertices.size());
+        const float cellSize = weldCellsPerTolerance * tolerance;
+        const float borderSize = 1.f / weldCellsPerTolerance;
+
+        // Quantize every vertex in parallel, the vertices are independent of each other
+        std::vector<WeldCell> cells(vertices.size());
+#pragma omp parallel for schedule(static)
+        for (std::int64_t i = 0; i < vertexCount; ++i) {
+            const auto p = vec3{vertices[i]} / cellSize;
+            const auto c = floor(p);
+            cells[i].cell = ivec3{c};
+            cells[i].side = ivec3{step(1.f - borderSize, p - c) - (1.f - step(borderSize, p - c))};
         }
-    };
 
-    std::pair<std::vector<vec4>, std::vector<unsigned int>> getVertexIndexPairs(const std::vector<vec4> &vertices) {
+        // Further unique vertices inside the same cell are chained through nextInCell, -1 marks the end
+        std::vector<WeldSlot> slots(16);
+        std::size_t usedSlots = 0;
         std::vector<vec4> uniqueVertices;
         uniqueVertices.reserve(vertices.size());
-        std::vector<unsigned int> indices;
-        indices.reserve(vertices.size());
+        std::vector<int> nextInCell;
+        nextInCell.reserve(vertices.size());
+        std::vector<unsigned int> indices(vertices.size());
+
+        // Every vertex is welded to the first unique vertex whose x, y and z all lie within the tolerance of it and
+        // that has the same w. Which vertex represents a weld depends on the order of the vertices, so this pass is
+        // sequential.
+        for (std::size_t i = 0; i < vertices.size(); ++i) {
+            const auto &v = vertices[i];
+            const auto &[cell, side] = cells[i];
+
+            int match = -1;
+            for (int n = 0; n < 8; ++n) {
+                const ivec3 offset = ivec3{n & 1, (n >> 1) & 1, (n >> 2) & 1} * side;
+                // Skip the duplicates of neighbours along axes that don't need to be searched
+                if ((n & 1 && offset.x == 0) || (n & 2 && offset.y == 0) || (n & 4 && offset.z == 0))
+                    continue;
 
-        std::map<vec4, unsigned int, vec4_comparator> lookupMap;
+                for (int u = slots[findSlot(slots, cell + offset)].head; u != -1; u = nextInCell[u]) {
+                    const auto &candidate = uniqueVertices[u];
+                    if ((match == -1 || u < match) && v.w == candidate.w &&
+                        all(lessThanEqual(abs(vec3{v} - vec3{candidate}), vec3{tolerance})))
+                        match = u;
+                }
+            }
 
-        for (const auto &v: vertices) {
-            const auto pos = lookupMap.find(v);
-            if (pos != lookupMap.end()) {
-                indices.push_back(pos->second);
-            } else {
+            if (match == -1) {
+                // Keep the table at most half full
+                if (slots.size() < 2 * (usedSlots + 1)) {
+                    std::vector<WeldSlot> grown(2 * slots.size());
+                    for (const auto &slot: slots)
+                        if (slot.head != -1)
+                            grown[findSlot(grown, slot.cell)] = slot;
+                    slots = std::move(grown);
+                }
+
+                match = static_cast<int>(uniqueVertices.size());
                 uniqueVertices.push_back(v);
-                const auto i = static_cast<unsigned int>(lookupMap.size());
-                indices.push_back(i);
-                lookupMap.emplace(v, i);
+                auto &slot = slots[findSlot(slots, cell)];
+                if (slot.head == -1)
+                    ++usedSlots;
+                slot.cell = cell;
+                nextInCell.push_back(slot.head);
+                slot.head = match;
             }
+            indices[i] = static_cast<unsigned int>(match);
         }
 
         uniqueVertices.shrink_to_fit();
-        indices.shrink_to_fit();
 
-        return std::make_pair(uniqueVertices, indices);
+        return std::make_pair(std::move(uniqueVertices), std::move(indices));
     }
 
-    // Graham scan implementation (first point should be start point / bounds max)
-    std::vector<unsigned int>
-    createConvexHull(const std::vector<std::pair<glm::dvec2, unsigned int>> &points, glm::dvec2 boundingCenter = {},
-                     const std::weak_ptr<bool> &controlFlag = {}) {
-        // Set comparison direction, the start of the polar angle circle, to be the first point
-        const auto compareDir = normalize(points[0].first - boundingCenter);
-
-        if (controlFlag.expired() || points.empty()) return {};
-
-        std::vector<std::tuple<dvec2, double, unsigned int>> nonEmptyValuesPolarAngled;
-        nonEmptyValuesPolarAngled.reserve(points.size());
-        nonEmptyValuesPolarAngled.emplace_back(points.at(0).first, 0.0, points.at(0).second);
-        for (auto it{points.begin() + 1}; it != points.end(); ++it) {
-            const auto &[p, i] = *it;
-            const auto dir = p - boundingCenter;
-            const auto dir_len = length(dir);
-            if (EPS < dir_len) {
-                const auto pa = dotBetween(compareDir, dir * (1. / dir_len));
-                nonEmptyValuesPolarAngled.emplace_back(p, pa, i);
-            }
-        }
-
-        if (controlFlag.expired()) return {};
-
-        // Sort points on polar angle
-        std::sort(nonEmptyValuesPolarAngled.begin(), nonEmptyValuesPolarAngled.end(), [](const auto &a, const auto &b) {
-            return std::get<1>(a) < std::get<1>(b);
+    // Andrew's monotone chain, returns the vertex indices of the hull in clockwise order
+    std::vector<unsigned int> createConvexHull(const HexagonCenters &points, const CancellationToken &cancellation) {
+        // Sort points lexicographically by x, then y
+        std::vector<std::size_t> order(points.size());
+        std::iota(order.begin(), order.end(), std::size_t{0});
+        std::sort(order.begin(), order.end(), [&points](std::size_t a, std::size_t b) {
+            return points.x[a] < points.x[b] || (points.x[a] == points.x[b] && points.y[a] < points.y[b]);
         });
 
-        if (controlFlag.expired()) return {};
-
-        // Graham scan implementation:
-        std::deque<std::pair<dvec2, unsigned int>> convexHullStack{};
-        for (const auto&[p, polar_angle, i]: nonEmptyValuesPolarAngled) {
-            // Skip empty/near-empty increments:
-            if (!convexHullStack.empty()) {
-                const auto last = convexHullStack[0].first;
-                const auto b = p - last;
-
-                if (length(b) < EPS)
-                    continue;
-            }
-
-            while (2 <= convexHullStack.size()) {
-                const auto last = convexHullStack[0].first;
-                const auto second_last = convexHullStack[1].first;
-                auto a = last - second_last;
-                auto b = p - last;
-
-                // If the new point forms a clockwise turn with the last points in the stack,
-                // pop the last point from the stack
-                if (!ccw(a, b, EPS))
-                    // Only pop last edge if new edge is a "valid" edge
-                    convexHullStack.pop_front();
-                else
+        if (cancellation.cancelled()) return {};
+
+        // Builds the lower hull from left to right and then the upper hull from right to left, popping points until
+        // the new point forms a counter-clockwise turn. Collinear points and duplicates are removed.
+        std::vector<std::size_t> stack;
+        stack.reserve(order.size() + 1);
+        const auto addPoint = [&](std::size_t i, std::size_t minSize) {
+            while (minSize <= stack.size()) {
+                const auto last = points.at(stack[stack.size() - 1]);
+                const auto secondLast = points.at(stack[stack.size() - 2]);
+                if (ccw(last - secondLast, points.at(i) - last, EPS))
                     break;
+                stack.pop_back();
             }
+            stack.push_back(i);
+        };
 
-            // Since points are sorted on polar coordinates and empty increments are skipped,
-            // no point that arrives here should give an empty increment
-
-            // Only add points that has a connected edge (or if there are no edges yet)
-            convexHullStack.emplace_front(p, i);
-
-            if (controlFlag.expired()) return {};
-        }
-
-        // After adding all points, end might be concave:
-        // pop end points until end -> start is convex
-        const auto p = convexHullStack.back().first;
-        while (2 <= convexHullStack.size()) {
-            const auto last = convexHullStack[0].first;
-            const auto second_last = convexHullStack[1].first;
-            auto a = last - second_last;
-            auto b = p - last;
-
-            if (!ccw(a, b, EPS))
-                convexHullStack.pop_front();
-            else
-                break;
-        }
-
-        return map(convexHullStack.begin(), convexHullStack.end(), [](const auto &h) { return h.second; });
+        for (const auto i: order)
+            addPoint(i, 2);
+        const auto lowerSize = stack.size() + 1;
+        for (auto it = order.rbegin() + 1; it != order.rend(); ++it)
+            addPoint(*it, lowerSize);
+        // The last point is the first point again
+        stack.pop_back();
+
+        // The cull shader expects the hull in clockwise order
+        std::vector<unsigned int> hull;
+        hull.reserve(stack.size());
+        for (auto it = stack.rbegin(); it != stack.rend(); ++it)
+            hull.push_back(points.hexIndices[*it]);
+        return hull;
     }
 
     std::optional<std::vector<vec4>>
-    geometryPostProcessing(const std::vector<vec4> &vertices, const std::weak_ptr<bool> &controlFlag) {
+    geometryPostProcessing(const std::vector<vec4> &vertices, const CancellationToken &cancellation) {
         // If we at this point don't have a buffer, it means it got recreated somewhere in the meantime.
         // In which case we don't need this thread anymore.
-        if (controlFlag.expired() || vertices.size() < 3)
+        if (cancellation.cancelled() || vertices.size() < 3)
             return std::nullopt;
 
-        // Filter out empty vertices
-        const auto filterEmptiesPoints = [](const auto &points) {
-            std::vector<vec4> data;
-            data.reserve(points.size());
-            for (auto it{points.begin()};
-                 it != points.end() && it + 1 != points.end() && it + 2 != points.end(); it += 3)
-                if (std::all_of(it, it + 3, [](const auto &p) { return EPS < p.w; }))
-                    data.insert(data.end(), it, it + 3);
-
-            data.shrink_to_fit();
-            return data;
-        };
+        // Filter out empty triangles, checking every few thousand triangles whether the result is still wanted
+        constexpr std::size_t cancellationInterval = 3 * 4096;
+        std::vector<vec4> data;
+        data.reserve(vertices.size());
+        for (std::size_t i{0}; i + 2 < vertices.size(); i += 3) {
+            if (i % cancellationInterval == 0 && cancellation.cancelled())
+                return std::nullopt;
+
+            const auto begin = vertices.begin() + static_cast<std::ptrdiff_t>(i);
+            if (std::all_of(begin, begin + 3, [](const auto &p) { return EPS < p.w; }))
+                data.insert(data.end(), begin, begin + 3);
+        }
 
-        return controlFlag.expired() ? std::nullopt : std::make_optional(filterEmptiesPoints(vertices));
+        data.shrink_to_fit();
+        return cancellation.cancelled() ? std::nullopt : std::make_optional(std::move(data));
     }
 
     std::optional<std::vector<uint>>
-    getHexagonConvexHull(const std::vector<vec4> &vertices, const std::weak_ptr<bool> &controlFlag,
+    getHexagonConvexHull(const std::vector<vec4> &hexCenters, const CancellationToken &cancellation,
                          float upperThreshold, float lowerThreshold) {
         // If we at this point don't have a buffer, it means it got recreated somewhere in the meantime.
         // In which case we don't need this thread anymore.
-        if (controlFlag.expired() || vertices.size() < 2)
+        if (cancellation.cancelled() || hexCenters.size() < 2)
             return std::nullopt;
 
-        const auto hexPositions = getHexagonPositions(vertices);
-
-        if (controlFlag.expired()) return std::nullopt;
-
         // Find the points which has a non-zero value of z (z height is hex-value, meaning empty ones are empty hexes)
-        std::vector<std::pair<dvec2, uint>> nonEmptyValues;
-        uint first = 0;
-        dvec2 mi{std::numeric_limits<float>::max()}, ma{std::numeric_limits<float>::min()};
-        nonEmptyValues.reserve(hexPositions.size());
-        for (uint i{0}; i < hexPositions.size(); ++i) {
-            const auto&[p, j] = hexPositions.at(i);
-            const auto w = dvec2{p.x, p.y};
-
+        HexagonCenters nonEmptyValues;
+        nonEmptyValues.x.reserve(hexCenters.size());
+        nonEmptyValues.y.reserve(hexCenters.size());
+        nonEmptyValues.hexIndices.reserve(hexCenters.size());
+        for (uint i{0}; i < hexCenters.size(); ++i) {
+            const auto &p = hexCenters[i];
             if (upperThreshold + static_cast<float>(EPS) < p.z || p.z < lowerThreshold - static_cast<float>(EPS)) {
-                mi = min(w, mi);
-                ma = max(w, ma);
-
-                nonEmptyValues.emplace_back(w, j);
-                // Also find smallest (for graham scan later)
-                const auto &oldSmallest = std::get<0>(nonEmptyValues[first]);
-                if (w.y < oldSmallest.y || w.y < oldSmallest.y + EPS && w.x < oldSmallest.x) // y' < y && x' <= x
-                    first = static_cast<uint>(nonEmptyValues.size() - 1);
+                nonEmptyValues.x.push_back(p.x);
+                nonEmptyValues.y.push_back(p.y);
+                nonEmptyValues.hexIndices.push_back(i);
             }
         }
-        const auto boundingCenter = 0.5 * mi + 0.5 * ma;
 
-        if (controlFlag.expired() || nonEmptyValues.size() < 2)
+        if (cancellation.cancelled() || nonEmptyValues.size() < 2)
             return std::nullopt;
 
-        // Make sure smallest is first
-        std::swap(nonEmptyValues[0], nonEmptyValues[first]);
+        const auto candidates = removeInteriorPoints(nonEmptyValues);
+
+        if (cancellation.cancelled()) return std::nullopt;
 
         // Create convex hull from hexagon positions
-        const auto convexHull = createConvexHull(nonEmptyValues, boundingCenter, controlFlag);
+        const auto convexHull = createConvexHull(candidates, cancellation);
+
+        return cancellation.cancelled() ? std::nullopt : std::make_optional(convexHull);
+    }
+
+    // Neighbours in doubled coordinates, in the same order as NEIGHBORS in geometry-constants.glsl
+    constexpr std::array<std::array<int, 2>, 6> HEX_NEIGHBORS{{{1, 1}, {0, 2}, {-1, 1}, {-1, -1}, {0, -2}, {1, -1}}};
+
+    /// Returns the ID of the neighbour of a hexagon in direction d, or -1 if the neighbour is outside of the grid
+    std::int64_t hexNeighbor(std::int64_t hexID, std::size_t d, int numCols, std::int64_t hexCount) {
+        // Same layout as the shaders: odd columns are shifted half a hexagon down
+        const auto col = static_cast<int>(hexID % numCols);
+        const auto row = hexID / numCols * 2 - col % 2;
+        const auto neighborCol = col + HEX_NEIGHBORS[d][0];
+        const auto neighborRow = row + HEX_NEIGHBORS[d][1] + neighborCol % 2;
+        if (neighborCol < 0 || numCols <= neighborCol || neighborRow < 0)
+            return -1;
+
+        const auto neighbor = neighborRow / 2 * numCols + neighborCol;
+        return neighbor < hexCount ? neighbor : -1;
+    }
+
+    /**
+     * Breadth first search over the hexagon grid, returning every hexagon that is a seed or is at most maxSteps
+     * steps away from one without passing through a blocked hexagon (an empty blocked list blocks nothing).
+     * If fromGridBorder is set, the space outside of the grid acts as an additional seed.
+     * Stops early, with an incomplete result, once cancelled.
+     */
+    std::vector<std::uint8_t>
+    hexGridReach(const std::vector<std::uint8_t> &seeds, const std::vector<std::uint8_t> &blocked,
+                 bool fromGridBorder, std::int64_t maxSteps, int numCols, const CancellationToken &cancellation) {
+        const auto hexCount = static_cast<std::int64_t>(seeds.size());
+        auto reached = seeds;
+        std::vector<std::int64_t> front, next;
+        for (std::int64_t i{0}; i < hexCount; ++i)
+            if (seeds[i])
+                front.push_back(i);
+
+        const auto visit = [&](std::int64_t i) {
+            if (0 <= i && !reached[i] && (blocked.empty() || !blocked[i])) {
+                reached[i] = 1;
+                next.push_back(i);
+            }
+        };
+
+        for (std::int64_t step{1}; step <= maxSteps && !cancellation.cancelled(); ++step) {
+            next.clear();
+            for (const auto i: front)
+                for (std::size_t d{0}; d < HEX_NEIGHBORS.size(); ++d)
+                    visit(hexNeighbor(i, d, numCols, hexCount));
+
+            // Hexagons on the grid border are one step away from the outside
+            if (step == 1 && fromGridBorder)
+                for (std::int64_t i{0}; i < hexCount; ++i)
+                    for (std::size_t d{0}; d < HEX_NEIGHBORS.size(); ++d)
+                        if (hexNeighbor(i, d, numCols, hexCount) < 0) {
+                            visit(i);
+                            break;
+                        }
+
+            if (next.empty())
+                break;
+            std::swap(front, next);
+        }
+
+        return reached;
+    }
+
+    std::optional<HexagonHullMask>
+    getHexagonConcaveHull(const std::vector<vec4> &hexCenters, const CancellationToken &cancellation,
+                          float upperThreshold, float lowerThreshold, int hexCount, int numCols, float tileScale,
+                          int closingRadius) {
+        if (cancellation.cancelled() || hexCount < 1 || numCols < 1)
+            return std::nullopt;
+
+        const auto count = static_cast<std::size_t>(hexCount);
+
+        // Mirrored geometry holds every hexagon twice, a hexagon is non-empty if either of them is
+        std::vector<std::uint8_t> nonEmpty(count, 0);
+        for (std::size_t i{0}; i < hexCenters.size(); ++i) {
+            const auto z = hexCenters[i].z;
+            if (upperThreshold + static_cast<float>(EPS) < z || z < lowerThreshold - static_cast<float>(EPS))
+                nonEmpty[i % count] = 1;
+        }
+
+        if (std::find(nonEmpty.begin(), nonEmpty.end(), 1) == nonEmpty.end())
+            return std::nullopt;
+
+        const auto closed = 0 < closingRadius ?
+                            hexGridReach(nonEmpty, {}, false, closingRadius, numCols, cancellation) : nonEmpty;
+
+        if (cancellation.cancelled()) return std::nullopt;
+
+        // Flood fill the empty space from outside of the grid, whatever it can't reach is enclosed by the data
+        auto outside = hexGridReach(std::vector<std::uint8_t>(count, 0), closed, true, hexCount, numCols,
+                                    cancellation);
+        if (0 < closingRadius)
+            outside = hexGridReach(outside, {}, true, closingRadius, numCols, cancellation);
+
+        if (cancellation.cancelled()) return std::nullopt;
+
+        HexagonHullMask hull;
+        hull.inside.resize(count);
+        for (std::size_t i{0}; i < count; ++i)
+            hull.inside[i] = nonEmpty[i] || !outside[i] ? 1u : 0u;
+
+        // Trace the edges between hexagons inside and outside of the hull (corner angles as in getOffset())
+        const auto hexAngle = glm::pi<float>() / 3.f;
+        for (std::size_t i{0}; i < count && i < hexCenters.size(); ++i) {
+            if (!hull.inside[i])
+                continue;
+
+            const auto &center = hexCenters[i];
+            for (std::size_t d{0}; d < HEX_NEIGHBORS.size(); ++d) {
+                const auto neighbor = hexNeighbor(static_cast<std::int64_t>(i), d, numCols, hexCount);
+                if (0 <= neighbor && hull.inside[neighbor])
+                    continue;
+
+                for (auto corner{d}; corner < d + 2; ++corner) {
+                    const auto angle = hexAngle * static_cast<float>(corner);
+                    hull.boundary.emplace_back(center.x + tileScale * std::cos(angle),
+                                               center.y + tileScale * std::sin(angle), 0.f, 1.f);
+                }
+            }
+        }
 
-        return controlFlag.expired() ? std::nullopt : std::make_optional(convexHull);
+        return cancellation.cancelled() ? std::nullopt : std::make_optional(std::move(hull));
     }
 }
\ No newline at end of file
@@ -9,6 +9,8 @@
 
 #include <glm/vec4.hpp>
 
+#include "ThreadPool.h"
+
 namespace globjects {
     class Buffer;
 }
@@ -48,14 +50,46 @@ namespace molumes {
     }
 
     std::optional<std::vector<glm::vec4>>
-    geometryPostProcessing(const std::vector<glm::vec4> &vertices, const std::weak_ptr<bool> &controlFlag);
+    geometryPostProcessing(const std::vector<glm::vec4> &vertices, const CancellationToken &cancellation);
 
+    /**
+     * Finds the convex hull of the non-empty hexagons, given the center of every hexagon (hexagons whose center
+     * height is outside of [lowerThreshold, upperThreshold] are non-empty).
+     * Returns the indices of the hull hexagons in clockwise order.
+     */
     std::optional<std::vector<glm::uint>>
-    getHexagonConvexHull(const std::vector<glm::vec4> &vertices, const std::weak_ptr<bool> &controlFlag,
+    getHexagonConvexHull(const std::vector<glm::vec4> &hexCenters, const CancellationToken &cancellation,
                          float upperThreshold, float lowerThreshold);
 
+    /// Concave hull of a hexagon grid, stored as a mask over the hexagons instead of a polygon
+    struct HexagonHullMask {
+        // 1 for every hexagon inside of the hull, indexed by hexagon ID
+        std::vector<glm::uint> inside;
+        // Pairs of line vertices along the hexagon edges that separate the hull from the outside
+        std::vector<glm::vec4> boundary;
+    };
+
+    /**
+     * Finds the hexagons inside of the concave hull of the non-empty hexagons, the hexagon grid counterpart of an
+     * alpha shape. Every hexagon that can be reached from outside of the grid without passing through a non-empty
+     * hexagon is outside, so holes and pockets are filled but empty space around the data is not. Before that,
+     * narrow gaps and notches in the data are closed by a morphological closing (dilation followed by erosion) with
+     * a hexagon of closingRadius hexagons, similar to the alpha of an alpha shape. Runs in O(hexagons).
+     * hexCenters are the hexagon centers as for getHexagonConvexHull().
+     */
+    std::optional<HexagonHullMask>
+    getHexagonConcaveHull(const std::vector<glm::vec4> &hexCenters, const CancellationToken &cancellation,
+                          float upperThreshold, float lowerThreshold, int hexCount, int numCols, float tileScale,
+                          int closingRadius);
+
+    /**
+     * Welds duplicate vertices of a triangle soup into unique vertices and an index buffer.
+     * A vertex is welded to the first unique vertex that has the same w and whose x, y and z each differ by at most
+     * tolerance from it, otherwise it becomes a new unique vertex. Unique vertices keep the order they first appear in.
+     * Lookups go through a spatial hash of cells eight tolerances wide, so welding is linear in the vertex count.
+     */
     std::pair<std::vector<glm::vec4>, std::vector<unsigned int>>
-    getVertexIndexPairs(const std::vector<glm::vec4> &vertices);
+    getVertexIndexPairs(const std::vector<glm::vec4> &vertices, float tolerance = 0.0001f);
 }
 
 #endif //MOLUMES_GEOMETRYUTILS_H
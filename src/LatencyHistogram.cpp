@@ -0,0 +1,42 @@
+#include "LatencyHistogram.h"
+
+#include <cmath>
+
+using namespace molumes;
+
+std::chrono::nanoseconds LatencyHistogram::Snapshot::percentile(double p) const {
+    if (total == 0)
+        return std::chrono::nanoseconds{0};
+
+    // Number of durations that have to be at or below the result
+    const auto rank = std::max<std::uint64_t>(
+            static_cast<std::uint64_t>(std::ceil(std::clamp(p, 0.0, 1.0) * static_cast<double>(total))), 1);
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        cumulative += counts[i];
+        if (rank <= cumulative)
+            return std::chrono::nanoseconds{bucket_upper(i)};
+    }
+    return max();
+}
+
+std::chrono::nanoseconds LatencyHistogram::Snapshot::max() const {
+    for (auto i = counts.size(); 0 < i; --i)
+        if (counts[i - 1] != 0)
+            return std::chrono::nanoseconds{bucket_upper(i - 1)};
+    return std::chrono::nanoseconds{0};
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot snapshot{.counts = std::vector<std::uint64_t>(BucketCount)};
+    for (std::size_t i = 0; i < BucketCount; ++i) {
+        snapshot.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        snapshot.total += snapshot.counts[i];
+    }
+    return snapshot;
+}
+
+void LatencyHistogram::reset() {
+    for (auto &count: m_counts)
+        count.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,93 @@
+#ifndef MOLUMES_LATENCYHISTOGRAM_H
+#define MOLUMES_LATENCYHISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace molumes {
+    /**
+     * @brief Lock-free histogram of durations with a bounded relative error (HDR histogram style)
+     *
+     * Durations are bucketed by their power of two and, within that, linearly into SubBuckets buckets, so every
+     * bucket is at most 1/(SubBuckets/2) ~ 3% wide relative to its value, from 1ns up to ~4s (longer durations end up
+     * in the last bucket). Recording is a single relaxed atomic increment and doesn't allocate, so it can be used from
+     * a real-time loop. There should only be one recording thread, other threads can read a snapshot at any time.
+     */
+    class LatencyHistogram {
+    public:
+        static constexpr unsigned int SubBucketBits = 6;
+        static constexpr std::uint64_t SubBuckets = 1u << SubBucketBits;
+        static constexpr std::uint64_t HalfSubBuckets = SubBuckets / 2;
+        static constexpr unsigned int MaxValueBits = 32;
+        static constexpr std::size_t BucketCount = (MaxValueBits - SubBucketBits + 1) * HalfSubBuckets + HalfSubBuckets;
+
+        static constexpr std::size_t bucket_index(std::uint64_t ns) {
+            ns = std::min<std::uint64_t>(ns, (std::uint64_t{1} << MaxValueBits) - 1);
+            const auto shift = std::max(static_cast<unsigned int>(std::bit_width(ns)), SubBucketBits) - SubBucketBits;
+            // Below SubBuckets the shift is 0 and the index is the value itself, above the top bit of (ns >> shift)
+            // is always set, so the sub bucket is in [HalfSubBuckets, SubBuckets)
+            return shift * HalfSubBuckets + static_cast<std::size_t>(ns >> shift);
+        }
+
+        // Smallest duration (in nanoseconds) that ends up in the bucket
+        static constexpr std::uint64_t bucket_lower(std::size_t index) {
+            if (index < SubBuckets)
+                return index;
+            const auto shift = index / HalfSubBuckets - 1;
+            return (index - shift * HalfSubBuckets) << shift;
+        }
+
+        // Largest duration (in nanoseconds) that ends up in the bucket
+        static constexpr std::uint64_t bucket_upper(std::size_t index) {
+            return index + 1 < BucketCount ? bucket_lower(index + 1) - 1 : (std::uint64_t{1} << MaxValueBits) - 1;
+        }
+
+        // Copy of the counts, to calculate statistics on
+        struct Snapshot {
+            std::vector<std::uint64_t> counts;
+            std::uint64_t total{0};
+
+            /// Largest duration of the p'th fraction (e.g. 0.99) of the recorded durations, 0 if nothing is recorded
+            [[nodiscard]] std::chrono::nanoseconds percentile(double p) const;
+
+            [[nodiscard]] std::chrono::nanoseconds max() const;
+        };
+
+        // Records the time between its creation and its destruction
+        class Scope {
+            LatencyHistogram &m_histogram;
+            std::chrono::steady_clock::time_point m_start{std::chrono::steady_clock::now()};
+
+        public:
+            explicit Scope(LatencyHistogram &histogram) : m_histogram{histogram} {}
+
+            Scope(const Scope &) = delete;
+
+            ~Scope() { m_histogram.record(std::chrono::steady_clock::now() - m_start); }
+        };
+
+        void record(std::chrono::nanoseconds duration) {
+            const auto ns = static_cast<std::uint64_t>(std::max(duration.count(), std::chrono::nanoseconds::rep{0}));
+            auto &count = m_counts[bucket_index(ns)];
+            // Only one thread records, so a load and a store is enough (and cheaper than a fetch_add)
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] Scope scope() { return Scope{*this}; }
+
+        [[nodiscard]] Snapshot snapshot() const;
+
+        // Clears the counts. Durations recorded while the histogram is reset may be kept.
+        void reset();
+
+    private:
+        std::array<std::atomic<std::uint64_t>, BucketCount> m_counts{};
+    };
+}
+
+#endif //MOLUMES_LATENCYHISTOGRAM_H
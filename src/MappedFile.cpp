@@ -0,0 +1,111 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace molumes;
+
+MappedFile::MappedFile(MappedFile &&rhs) noexcept {
+    *this = std::move(rhs);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&rhs) noexcept {
+    if (this != &rhs) {
+        close();
+        m_data = std::exchange(rhs.m_data, nullptr);
+        m_size = std::exchange(rhs.m_size, 0);
+#ifdef _WIN32
+        m_file = std::exchange(rhs.m_file, nullptr);
+        m_mapping = std::exchange(rhs.m_mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+std::optional<MappedFile> MappedFile::open(const std::string &path) {
+    MappedFile file;
+    file.m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file.m_file == INVALID_HANDLE_VALUE) {
+        file.m_file = nullptr;
+        return std::nullopt;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file.m_file, &size) || size.QuadPart == 0)
+        return std::nullopt;
+    file.m_size = static_cast<std::size_t>(size.QuadPart);
+
+    file.m_mapping = CreateFileMappingA(file.m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (file.m_mapping == nullptr)
+        return std::nullopt;
+
+    file.m_data = static_cast<const std::byte *>(MapViewOfFile(file.m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (file.m_data == nullptr)
+        return std::nullopt;
+
+    return file;
+}
+
+void MappedFile::close() {
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr)
+        CloseHandle(m_mapping);
+    if (m_file != nullptr)
+        CloseHandle(m_file);
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+}
+
+#else
+
+std::optional<MappedFile> MappedFile::open(const std::string &path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return std::nullopt;
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    void *ptr = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file, so the descriptor is no longer needed.
+    ::close(fd);
+    if (ptr == MAP_FAILED)
+        return std::nullopt;
+
+    MappedFile file;
+    file.m_data = static_cast<const std::byte *>(ptr);
+    file.m_size = static_cast<std::size_t>(st.st_size);
+    return file;
+}
+
+void MappedFile::close() {
+    if (m_data != nullptr)
+        munmap(const_cast<std::byte *>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef MOLUMES_MAPPEDFILE_H
+#define MOLUMES_MAPPEDFILE_H
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace molumes {
+    /**
+     * @brief Read-only memory mapping of a whole file.
+     *
+     * Move-only handle that unmaps the file when it goes out of scope. Use MappedFile::open() to create one.
+     */
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        MappedFile(MappedFile &&rhs) noexcept;
+        MappedFile &operator=(MappedFile &&rhs) noexcept;
+        ~MappedFile();
+
+        /// Maps the given file into memory, or returns std::nullopt if the file could not be opened or mapped.
+        static std::optional<MappedFile> open(const std::string &path);
+
+        [[nodiscard]] const std::byte *data() const { return m_data; }
+        [[nodiscard]] std::size_t size() const { return m_size; }
+        [[nodiscard]] std::span<const std::byte> bytes() const { return {m_data, m_size}; }
+
+    private:
+        void close();
+
+        const std::byte *m_data = nullptr;
+        std::size_t m_size = 0;
+#ifdef _WIN32
+        void *m_file = nullptr;
+        void *m_mapping = nullptr;
+#endif
+    };
+}
+
+#endif //MOLUMES_MAPPEDFILE_H
@@ -0,0 +1,130 @@
+#include "MipPyramid.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MOLUMES_MIPPYRAMID_SSE
+
+#include <emmintrin.h>
+
+#endif
+
+using namespace molumes;
+
+namespace {
+    // Levels with fewer texels are filtered on the calling thread, as starting the threads costs more than it gains
+    constexpr std::size_t MinParallelTexels = 1u << 14;
+
+    // Source texels, and their weights, of one destination texel along one axis
+    struct AxisFilter {
+        std::size_t first;
+        std::size_t taps;
+        std::array<float, 3> weights;
+    };
+
+    /*
+     * Even sizes are halved by averaging pairs. For odd sizes every destination texel covers 2.x source texels, so it
+     * is filtered from 3 source texels weighted by how much of them it covers. This way no source row or column is
+     * dropped and the weights sum to 1.
+     */
+    AxisFilter axis_filter(std::size_t src_size, std::size_t dst_size, std::size_t i) {
+        if (src_size == 1)
+            return {0, 1, {1.f, 0.f, 0.f}};
+        if (src_size == 2 * dst_size)
+            return {2 * i, 2, {0.5f, 0.5f, 0.f}};
+        const auto size = static_cast<float>(src_size);
+        return {2 * i, 3, {static_cast<float>(dst_size - i) / size, static_cast<float>(dst_size) / size,
+                           static_cast<float>(i + 1) / size}};
+    }
+
+    // One texel, 4-wide
+#ifdef MOLUMES_MIPPYRAMID_SSE
+    using Texel = __m128;
+
+    Texel load(const glm::vec4 &t) { return _mm_loadu_ps(&t.x); }
+
+    void store(glm::vec4 &t, Texel v) { _mm_storeu_ps(&t.x, v); }
+
+    Texel zero() { return _mm_setzero_ps(); }
+
+    Texel add(Texel a, Texel b) { return _mm_add_ps(a, b); }
+
+    Texel scale(Texel a, float s) { return _mm_mul_ps(a, _mm_set1_ps(s)); }
+#else
+    using Texel = glm::vec4;
+
+    Texel load(const glm::vec4 &t) { return t; }
+
+    void store(glm::vec4 &t, Texel v) { t = v; }
+
+    Texel zero() { return glm::vec4{0.f}; }
+
+    Texel add(Texel a, Texel b) { return a + b; }
+
+    Texel scale(Texel a, float s) { return a * s; }
+#endif
+
+    // 2x2 box filter of row y, for source levels with exactly twice the size of the destination
+    void halve_row(const glm::vec4 *src, const glm::uvec2 &src_dims, glm::vec4 *dst, const glm::uvec2 &dst_dims,
+                   std::size_t y) {
+        const auto *row0 = src + 2 * y * src_dims.x;
+        const auto *row1 = row0 + src_dims.x;
+        auto *out = dst + y * dst_dims.x;
+        for (std::size_t x = 0; x < dst_dims.x; ++x) {
+            const auto sum = add(add(load(row0[2 * x]), load(row0[2 * x + 1])),
+                                 add(load(row1[2 * x]), load(row1[2 * x + 1])));
+            store(out[x], scale(sum, 0.25f));
+        }
+    }
+
+    // Filter of row y for any other size (odd width or height, or a 1 texel wide or high source)
+    void filter_row(const glm::vec4 *src, const glm::uvec2 &src_dims, glm::vec4 *dst, const glm::uvec2 &dst_dims,
+                    std::size_t y) {
+        const auto rows = axis_filter(src_dims.y, dst_dims.y, y);
+        auto *out = dst + y * dst_dims.x;
+        for (std::size_t x = 0; x < dst_dims.x; ++x) {
+            const auto columns = axis_filter(src_dims.x, dst_dims.x, x);
+            auto sum = zero();
+            for (std::size_t r = 0; r < rows.taps; ++r) {
+                const auto *row = src + (rows.first + r) * src_dims.x + columns.first;
+                auto row_sum = zero();
+                for (std::size_t c = 0; c < columns.taps; ++c)
+                    row_sum = add(row_sum, scale(load(row[c]), columns.weights[c]));
+                sum = add(sum, scale(row_sum, rows.weights[r]));
+            }
+            store(out[x], sum);
+        }
+    }
+}
+
+MipPyramid::MipPyramid(const glm::uvec2 &dims, std::span<const glm::vec4> base) {
+    glm::uvec2 level_dims = dims.x == 0 || dims.y == 0 ? glm::uvec2{0u} : dims;
+    for (std::size_t i = 0; i < LevelCount; ++i) {
+        m_dims[i] = level_dims;
+        m_offsets[i + 1] = m_offsets[i] + static_cast<std::size_t>(level_dims.x) * level_dims.y;
+        if (level_dims.x != 0)
+            level_dims = {std::max(level_dims.x / 2u, 1u), std::max(level_dims.y / 2u, 1u)};
+    }
+
+    m_texels.resize(m_offsets.back());
+    std::copy_n(base.begin(), std::min(base.size(), m_offsets[1]), m_texels.begin());
+}
+
+void MipPyramid::generate() {
+    for (std::size_t level = 1; level < LevelCount; ++level) {
+        const auto src_dims = m_dims[level - 1];
+        const auto dst_dims = m_dims[level];
+        const auto *src = m_texels.data() + m_offsets[level - 1];
+        auto *dst = m_texels.data() + m_offsets[level];
+        const bool halved = src_dims.x == 2 * dst_dims.x && src_dims.y == 2 * dst_dims.y;
+
+        // Every row only reads the previous level, so the rows of a level are independent
+#pragma omp parallel for schedule(static) if (static_cast<std::size_t>(dst_dims.x) * dst_dims.y >= MinParallelTexels)
+        for (int y = 0; y < static_cast<int>(dst_dims.y); y++) {
+            if (halved)
+                halve_row(src, src_dims, dst, dst_dims, static_cast<std::size_t>(y));
+            else
+                filter_row(src, src_dims, dst, dst_dims, static_cast<std::size_t>(y));
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef MOLUMES_MIPPYRAMID_H
+#define MOLUMES_MIPPYRAMID_H
+
+#include "Constants.h"
+
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <array>
+#include <span>
+#include <vector>
+
+namespace molumes {
+    /**
+     * @brief The HapticMipMapLevels mip map levels of a texture in one contiguous allocation
+     *
+     * Every level is stored row-major (so it can be uploaded to OpenGL directly) right after the previous one. Like
+     * OpenGL, each level has half the size (rounded down, but at least 1) of the previous level.
+     */
+    class MipPyramid {
+    public:
+        static constexpr std::size_t LevelCount = HapticMipMapLevels;
+
+        MipPyramid() = default;
+
+        // Allocates all levels and copies base into level 0. The other levels are left zeroed.
+        MipPyramid(const glm::uvec2 &dims, std::span<const glm::vec4> base);
+
+        /// Fills levels 1 and up from level 0, every level is filtered from the one before it. Rows are filtered in
+        /// parallel (OpenMP) and texels 4-wide. Odd sizes are filtered by area, so no row or column is dropped.
+        void generate();
+
+        [[nodiscard]] bool empty() const { return m_texels.empty(); }
+
+        [[nodiscard]] glm::uvec2 dims(std::size_t level) const { return m_dims.at(level); }
+
+        [[nodiscard]] std::span<const glm::vec4> level(std::size_t level) const {
+            return std::span<const glm::vec4>{m_texels}.subspan(m_offsets.at(level),
+                                                                 m_offsets.at(level + 1) - m_offsets.at(level));
+        }
+
+        [[nodiscard]] std::span<glm::vec4> level(std::size_t level) {
+            return std::span<glm::vec4>{m_texels}.subspan(m_offsets.at(level),
+                                                           m_offsets.at(level + 1) - m_offsets.at(level));
+        }
+
+    private:
+        std::array<glm::uvec2, LevelCount> m_dims{};
+        // Offset of every level into m_texels, the last entry is the total texel count
+        std::array<std::size_t, LevelCount + 1> m_offsets{};
+        std::vector<glm::vec4> m_texels;
+    };
+}
+
+#endif //MOLUMES_MIPPYRAMID_H
@@ -61,155 +61,56 @@ opt_relative_pos_coords(const glm::vec3 &pos, const glm::mat4 &pl_mat, const glm
     });
 }
 
-// Opengl 4.0 Specs: glReadPixels: Pixels are returned in row order from the lowest to the highest row, left to right in each row.
-// (0,0) is therefore the top left coordinate (meaning uv coordinates have the v coordinate flipped)
-std::optional<glm::vec4>
-get_pixel(const glm::uvec2 &coord, const glm::uvec2 tex_dims, const std::vector<glm::vec4> &tex_data) {
-    if (tex_data.empty() || tex_dims.x == 0 || tex_dims.y == 0 || tex_dims.x <= coord.x || tex_dims.y <= coord.y)
-        return std::nullopt;
-    return std::make_optional(tex_data.at(coord.y * tex_dims.x + coord.x));
-};
-
-/**
- * @brief Convert UVs into rectangular UVs
- * The mip maps are calculated in screen-space pixel coordinates, which is typically widescreen. So this function
- * counteracts the widescreen by transforming the uv-coordinates back to a rectangular format.
- *
- * TODO: Since the textures are only generated for the purpose of sampling them here, the textures could be
- * made quads in the mip map generation process instead, saving some calculations here.
- */
-glm::vec2 rect_uvs(const glm::uvec2 &tex_dims, const glm::vec2 &uv) {
-    const float x_min = 0.5f - static_cast<float>(tex_dims.y) / static_cast<float>(tex_dims.x + tex_dims.x);
-    return {(1.f - x_min - x_min) * uv.x + x_min, uv.y};
+// The 4 central difference taps around uv, in the order +x, -x, +y, -y (clamped to [0, 1])
+std::array<glm::vec2, 4> central_difference_taps(const glm::vec2 &uv, float kernel) {
+    return {glm::vec2{std::min(uv.x + kernel, 1.f), uv.y}, glm::vec2{std::max(uv.x - kernel, 0.f), uv.y},
+            glm::vec2{uv.x, std::min(uv.y + kernel, 1.f)}, glm::vec2{uv.x, std::max(uv.y - kernel, 0.f)}};
 }
 
-// Bi-linear interpolation of pixel
-glm::vec4 sample_tex(const glm::vec2 &uv, const glm::uvec2 tex_dims, const std::vector<glm::vec4> &tex_data) {
-    const auto m_get_pixel = [tex_dims, &tex_data = std::as_const(tex_data)](const glm::uvec2 &coord) {
-        return get_pixel(coord, tex_dims, tex_data);
-    };
-
-    const glm::vec2 pixel_coord = rect_uvs(tex_dims, uv) * glm::vec2{tex_dims + 1u};
-    const glm::vec2 f_pixel_coord = glm::fract(pixel_coord);
-    const glm::uvec2 i_pixel_coord = glm::uvec2{pixel_coord - f_pixel_coord};
-
-    auto aa = m_get_pixel(i_pixel_coord);
-    auto ba = m_get_pixel(glm::uvec2{i_pixel_coord.x + 1u, i_pixel_coord.y});
-    auto ab = m_get_pixel(glm::uvec2{i_pixel_coord.x, i_pixel_coord.y + 1u});
-    auto bb = m_get_pixel(glm::uvec2{i_pixel_coord.x + 1u, i_pixel_coord.y + 1u});
-    if (!aa || !ba || !ab || !bb)
-        return glm::vec4{0.};
-
-    // Convert to normalized range:
-    const auto n_aa = glm::vec4{glm::vec3{*aa} * 2.f - 1.f, aa->w};
-    const auto n_ba = glm::vec4{glm::vec3{*ba} * 2.f - 1.f, ba->w};
-    const auto n_ab = glm::vec4{glm::vec3{*ab} * 2.f - 1.f, ab->w};
-    const auto n_bb = glm::vec4{glm::vec3{*bb} * 2.f - 1.f, bb->w};
-
-    glm::vec4 s = glm::mix(
-            glm::mix(n_aa, n_ba, f_pixel_coord.x),
-            glm::mix(n_ab, n_bb, f_pixel_coord.x),
-            f_pixel_coord.y);
-
-    return glm::any(glm::isnan(s)) ? glm::vec4{0.f} : s;
-}
-
-
 /**
- * @brief The same as sample_tex, but only with height.
- * On a GPU most stuff is passed as a vec4 anyway, so interpolating vec4's and then swizzling the last component is
- * just as fast as interpolating singular floats. But on a CPU a singular component function could be optimized by the
- * compiler.
+ * @brief Sample a volume gradient using central differences
+ * The volume is constructed from 2 texture slices. Its density is the (un?)signed height differences between the
+ * slices. The xy-part of the sampling coordinates translates to the uv-coordinates in the plane, and the z-coordinate
+ * translates to the difference between the 2 slices - the interpolation from the first layer to the second layer.
+ * All 4 taps of the central differences are sampled at once per slice.
  */
-float sample_height(const glm::vec2 &uv, const glm::uvec2 tex_dims, const std::vector<glm::vec4> &tex_data) {
-    const auto m_get_pixel = [tex_dims, &tex_data = std::as_const(tex_data)](const glm::uvec2 &coord) {
-        return get_pixel(coord, tex_dims, tex_data);
-    };
-
-    const glm::vec2 pixel_coord = rect_uvs(tex_dims, uv) * glm::vec2{tex_dims + 1u};
-    const glm::vec2 f_pixel_coord = glm::fract(pixel_coord);
-    const glm::uvec2 i_pixel_coord = glm::uvec2{pixel_coord - f_pixel_coord};
-
-    auto aa = m_get_pixel(i_pixel_coord);
-    auto ba = m_get_pixel(glm::uvec2{i_pixel_coord.x + 1u, i_pixel_coord.y});
-    auto ab = m_get_pixel(glm::uvec2{i_pixel_coord.x, i_pixel_coord.y + 1u});
-    auto bb = m_get_pixel(glm::uvec2{i_pixel_coord.x + 1u, i_pixel_coord.y + 1u});
-    if (!aa || !ba || !ab || !bb)
-        return 0.f;
-
-    const auto s = std::lerp(
-            std::lerp(aa->w, ba->w, f_pixel_coord.x),
-            std::lerp(ab->w, bb->w, f_pixel_coord.x),
-            f_pixel_coord.y);
-
-    return std::isnan(s) ? 0.f : s;
-}
-
-/**
- * @brief Samples texture slices like a volume.
- * Using 2 slices, samples a density in a volume constructed from the slices, using the (un?)signed height differences
- * as the density. The xy-part of the sampling coordinates translates to the uv-coordinates in the plane, and the
- * z-coordinate translates to the difference between the 2 slices - the interpolation from the first layer to the
- * second layer.
- */
-float sample_volume_tf(const glm::vec3 &coord, const TextureMipMaps &tex_mip_maps,
-                       std::array<unsigned int, 2> levels, bool use_height_differences = false,
-                       float mip_map_scale_mutliplier = 1.5f) {
-    const auto &[dims0, data0] = tex_mip_maps.at(levels[0]);
-    const auto &[dims1, data1] = tex_mip_maps.at(levels[1]);
-
-    // If coordinates are outside of bounds, just return 0 as the density (air)
-    // It is a logic error if we use the transfer function on invalid coords, so assert here:
-    assert(!(glm::any(glm::lessThan(coord, glm::vec3{0.f})) || glm::any(glm::greaterThan(coord, glm::vec3{1.f}))));
-
-    const auto t0 = sample_height(glm::vec2{coord}, dims0, data0) *
-                    std::pow(mip_map_scale_mutliplier, static_cast<float>(levels[0]));
-    const auto t1 = sample_height(glm::vec2{coord}, dims1, data1) *
-                    std::pow(mip_map_scale_mutliplier, static_cast<float>(levels[1]));
-
-    // (t1 - coord.z) - (t0 - coord.z) =
-    return use_height_differences ? (t1 - t0) : std::lerp(t0, t1, coord.z);
-}
-
-// Sample a volume gradient using central differences
-glm::dvec2 sample_volume_gradient(const glm::vec3 &coords, const TextureMipMaps &tex_mip_maps,
+glm::dvec2 sample_volume_gradient(const glm::vec3 &coords, const SampledMipPyramid &tex_mip_maps,
                                   std::array<unsigned int, 2> levels, float kernel_size = 0.001f,
                                   bool use_height_differences = false, float mip_map_scale_multiplier = 1.5f) {
-    using namespace glm;
-    const auto &tf = [&tex_mip_maps, levels, mip_map_scale_multiplier, use_height_differences](const vec3 &coord) {
-        return sample_volume_tf(coord, tex_mip_maps, levels, use_height_differences, mip_map_scale_multiplier);
-    };
-
     if (glm::any(glm::lessThan(coords, glm::vec3{0.f})) || glm::any(glm::greaterThan(coords, glm::vec3{1.f})))
         return {0.0, 0.0};
 
+    const auto taps = central_difference_taps(glm::vec2{coords}, kernel_size);
+    const auto h0 = tex_mip_maps.at(levels[0]).gather_heights(taps);
+    const auto h1 = tex_mip_maps.at(levels[1]).gather_heights(taps);
+    const auto scale0 = std::pow(mip_map_scale_multiplier, static_cast<float>(levels[0]));
+    const auto scale1 = std::pow(mip_map_scale_multiplier, static_cast<float>(levels[1]));
+
+    std::array<float, 4> tf;
+    for (std::size_t i = 0; i < 4; ++i) {
+        const auto t0 = h0[i] * scale0;
+        const auto t1 = h1[i] * scale1;
+        // (t1 - coord.z) - (t0 - coord.z) =
+        tf[i] = use_height_differences ? (t1 - t0) : std::lerp(t0, t1, coords.z);
+    }
+
     /**
      * Volume gradient is central differences of transfer function in the X and Y directions, and an interpolated
      * constant upwards aligned vector in the Z-direction.
      */
-    return {
-            tf(vec3{std::min(coords.x + kernel_size, 1.f), coords.y, coords.z}) -
-            tf(vec3{std::max(coords.x - kernel_size, 0.f), coords.y, coords.z}),
-            tf(vec3{coords.x, std::min(coords.y + kernel_size, 1.f), coords.z}) -
-            tf(vec3{coords.x, std::max(coords.y - kernel_size, 0.f), coords.z})
-    };
+    return {tf[0] - tf[1], tf[2] - tf[3]};
 }
 
-glm::dvec2 surface_gradient(const glm::vec2 &uv, const glm::uvec2 &tex_dims, const std::vector<glm::vec4> &tex_data,
-                            float kernel = 0.001f) {
-    const auto tf = [&](const glm::vec2 &uv) { return sample_height(uv, tex_dims, tex_data); };
+glm::dvec2 surface_gradient(const glm::vec2 &uv, const SampledTexture &tex, float kernel = 0.001f) {
     // Note: Using the same kernel in x and y direction doesn't seem to change anything when using oblong textures
-    return {
-            tf({std::min(uv.x + kernel, 1.f), uv.y}) - tf({std::max(uv.x - kernel, 0.f), uv.y}),
-            tf({uv.x, std::min(uv.y + kernel, 1.f)}) - tf({uv.x, std::max(uv.y - kernel, 0.f)})
-    };
+    const auto h = tex.gather_heights(central_difference_taps(uv, kernel));
+    return {h[0] - h[1], h[2] - h[3]};
 }
 
 // Basically does the same on the CPU as calculateNormalFromHeightMap() from res/tiles/globals.glsl does on the GPU
-glm::dvec3
-surface_normal_from_gradient(const glm::vec2 &uv, const glm::uvec2 &tex_dims, const std::vector<glm::vec4> &tex_data) {
+glm::dvec3 surface_normal_from_gradient(const glm::vec2 &uv, const SampledTexture &tex) {
     using namespace glm;
-    const auto g = surface_gradient(uv, tex_dims, tex_data) * 100.0; // Arbitrary scaling number for gradient
+    const auto g = surface_gradient(uv, tex) * 100.0; // Arbitrary scaling number for gradient
     return normalize(cross(normalize(dvec3{1.0, 0.0, g.x}), normalize(dvec3{0.0, 1.0, g.y})));
 }
 
@@ -318,18 +219,17 @@ using NormalLevelSampleResult = std::pair<float, std::optional<glm::dvec3>>;
  * of the haptic device.
  */
 NormalLevelSampleResult
-sample_normal_force(const glm::vec3 &relative_coords, const glm::uvec2 &tex_dims,
-                    const std::vector<glm::vec4> &tex_data, float surface_height_multiplier = 1.f,
+sample_normal_force(const glm::vec3 &relative_coords, const SampledTexture &tex, float surface_height_multiplier = 1.f,
                     bool pre_interpolative = true) {
     const auto uv = glm::vec2{relative_coords};
     float height{0.f};
     glm::dvec3 normal{};
     if (pre_interpolative) {
-        const auto h = sample_height(uv, tex_dims, tex_data);
+        const auto h = tex.sample_height(uv);
         height = relative_coords.z - h * surface_height_multiplier;
-        normal = surface_normal_from_gradient(uv, tex_dims, tex_data);
+        normal = surface_normal_from_gradient(uv, tex);
     } else {
-        const auto value = sample_tex(uv, tex_dims, tex_data);
+        const auto value = tex.sample(uv);
         height = relative_coords.z - value.w * surface_height_multiplier;
         normal = {value};
     }
@@ -355,13 +255,12 @@ sample_normal_force(const glm::vec3 &relative_coords, const glm::uvec2 &tex_dims
     return {height, glm::any(glm::isnan(normal)) ? std::nullopt : std::make_optional(normal)};
 }
 
-NormalLevelSampleResult sample_normal_level(const TextureMipMaps &tex_mip_maps,
+NormalLevelSampleResult sample_normal_level(const SampledMipPyramid &tex_mip_maps,
                                             const SizedQueue<Physics::SimulationStepData, 2> &simulation_steps,
                                             glm::dvec3 coords, unsigned int level, float surface_height_multiplier,
                                             double surface_force, bool pre_interpolative = true) {
-    const auto &[dims, data] = tex_mip_maps.at(level);
-
-    const auto sample_res = sample_normal_force(coords, dims, data, surface_height_multiplier, pre_interpolative);
+    const auto sample_res = sample_normal_force(coords, tex_mip_maps.at(level), surface_height_multiplier,
+                                                pre_interpolative);
     const auto &[surface_height, opt_normal_force] = sample_res;
 
     // Early exit of there's no surface force (we're moving through air / empty space)
@@ -372,20 +271,20 @@ NormalLevelSampleResult sample_normal_level(const TextureMipMaps &tex_mip_maps,
 }
 
 std::optional<Physics::NormalLevelResult>
-sample_volume(double surface_force, float surface_softness, const TextureMipMaps &tex_mip_maps,
+sample_volume(double surface_force, float surface_softness, const SampledMipPyramid &tex_mip_maps,
               const std::optional<float> &sphere_kernel_radius,
               const glm::vec3 &coords, unsigned int surface_volume_mip_map_counts, float t,
               bool use_height_differences = false, float mip_map_scale_multiplier = 1.5f,
               unsigned int min_mip_map = 0) {
-    // Get upper and lower mip map levels:
-    const auto enabled_mip_maps = generate_enabled_mip_maps(surface_volume_mip_map_counts, min_mip_map);
+    // Get upper and lower mip map levels (computed directly, as this runs every haptic tick and must not allocate):
     const auto enabled_mip_maps_range_mult = static_cast<float>(surface_volume_mip_map_counts - 1);
 
     // t(z) = [0, 1], z = [-0.25, 0.25]
-    const auto upper_j = static_cast<std::size_t>(std::ceil(t * enabled_mip_maps_range_mult));
-    const auto lower_j = static_cast<std::size_t>(std::floor(t * enabled_mip_maps_range_mult));
-    auto upper_level = enabled_mip_maps.at(upper_j);
-    auto lower_level = enabled_mip_maps.at(lower_j);
+    const auto upper_j = std::min(static_cast<unsigned int>(std::ceil(t * enabled_mip_maps_range_mult)),
+                                  surface_volume_mip_map_counts - 1);
+    const auto lower_j = std::min(static_cast<unsigned int>(std::floor(t * enabled_mip_maps_range_mult)), upper_j);
+    auto upper_level = enabled_mip_map(upper_j, surface_volume_mip_map_counts, min_mip_map);
+    auto lower_level = enabled_mip_map(lower_j, surface_volume_mip_map_counts, min_mip_map);
 
     const auto f_f = t * enabled_mip_maps_range_mult - static_cast<float>(lower_j);
 
@@ -425,7 +324,7 @@ outside_surface(const glm::dvec3 &pos, const glm::dvec3 &pl_norm, const glm::dve
 namespace molumes {
     glm::dvec3 Physics::simulate_and_sample_force(double surface_force, float surface_softness,
                                                   float surface_height_multiplier, unsigned int mip_map_level,
-                                                  const TextureMipMaps &tex_mip_maps, glm::dvec3 pos,
+                                                  const SampledMipPyramid &tex_mip_maps, glm::dvec3 pos,
                                                   std::optional<float> friction_scale,
                                                   std::optional<float> gravity_factor,
                                                   std::optional<unsigned int> surface_volume_mip_map_counts,
@@ -538,7 +437,7 @@ namespace molumes {
     std::optional<Physics::NormalLevelResult>
     Physics::sample_normal(const glm::vec3 &coords, double surface_force, float surface_softness,
                            float surface_height_multiplier, unsigned int mip_map_level,
-                           const TextureMipMaps &tex_mip_maps, const glm::dvec3 &pos,
+                           const SampledMipPyramid &tex_mip_maps, const glm::dvec3 &pos,
                            const std::optional<unsigned int> &surface_volume_mip_map_counts,
                            const std::optional<float> &sphere_kernel_radius,
                            bool volume_use_height_differences, float mip_map_scale_multiplier,
@@ -556,10 +455,8 @@ namespace molumes {
             // If inside volume:
             if (0.f < t) {
                 // Check if when we sample the actual height we're still inside the volume
-                const auto &[floor_dims, floor_data] = tex_mip_maps.at(mip_map_level);
                 const auto floor_height =
-                        sample_height({coords}, floor_dims, floor_data) * surface_height_multiplier -
-                        0.25f;
+                        tex_mip_maps.at(mip_map_level).sample_height({coords}) * surface_height_multiplier - 0.25f;
                 const float t_h = coords.z / (0.25f - floor_height) - floor_height / (0.25f - floor_height);
 
                 // If the actual height says we're still inside the volume:
@@ -616,14 +513,18 @@ namespace molumes {
         }
     }
 
+    unsigned int enabled_mip_map(unsigned int i, unsigned int enabled_count, unsigned int min_mip_map) {
+        return static_cast<unsigned int>(std::round(
+                static_cast<float>((HapticMipMapLevels - 1 - min_mip_map) * i) /
+                static_cast<float>(enabled_count - 1) + 0.01f
+        )) + min_mip_map;
+    }
+
     std::vector<unsigned int> generate_enabled_mip_maps(unsigned int enabled_count, unsigned int min_mip_map) {
         std::vector<unsigned int> out;
         out.reserve(enabled_count);
         for (unsigned int i{0}; i < enabled_count; ++i)
-            out.push_back(static_cast<unsigned int>(std::round(
-                    static_cast<float>((HapticMipMapLevels - 1 - min_mip_map) * i) /
-                    static_cast<float>(enabled_count - 1) + 0.01f
-            )) + min_mip_map);
+            out.push_back(enabled_mip_map(i, enabled_count, min_mip_map));
         return out;
     }
 
@@ -2,6 +2,7 @@
 #define MOLUMES_PHYSICS_H
 
 #include "Constants.h"
+#include "TextureSampler.h"
 
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
@@ -59,8 +60,6 @@ namespace molumes {
         // Directional
     };
 
-    using TextureMipMaps = std::array<std::pair<glm::uvec2, std::vector<glm::vec4>>, HapticMipMapLevels>;
-
     /**
      * Utility object for physics simulation and force calculation.
      * Not only completely pure functions because it keeps an internal track of data from previous simulation steps.
@@ -109,7 +108,7 @@ namespace molumes {
     public:
         glm::dvec3
         simulate_and_sample_force(double surface_force, float surface_softness, float surface_height_multiplier,
-                                  unsigned int mip_map_level, const TextureMipMaps &tex_mip_maps, glm::dvec3 pos,
+                                  unsigned int mip_map_level, const SampledMipPyramid &tex_mip_maps, glm::dvec3 pos,
                                   std::optional<float> friction_scale = std::nullopt,
                                   std::optional<float> gravity_factor = std::nullopt,
                                   std::optional<unsigned int> surface_volume_mip_map_counts = std::nullopt,
@@ -120,13 +119,17 @@ namespace molumes {
         std::optional<NormalLevelResult>
         sample_normal(const glm::vec3 &coords, double surface_force, float surface_softness,
                       float surface_height_multiplier,
-                      unsigned int mip_map_level, const TextureMipMaps &tex_mip_maps, const glm::dvec3 &pos,
+                      unsigned int mip_map_level, const SampledMipPyramid &tex_mip_maps, const glm::dvec3 &pos,
                       const std::optional<unsigned int> &surface_volume_mip_map_counts,
                       const std::optional<float> &sphere_kernel_radius,
                       bool volume_use_height_differences, float mip_map_scale_multiplier, bool pre_interpolative_normal,
                       bool intersection_constraint);
     };
 
+    // The i'th of enabled_count mip map levels spread evenly over [min_mip_map, HapticMipMapLevels - 1]
+    unsigned int enabled_mip_map(unsigned int i, unsigned int enabled_count = HapticMipMapLevels,
+                                 unsigned int min_mip_map = 0);
+
     std::vector<unsigned int>
     generate_enabled_mip_maps(unsigned int enabled_count = HapticMipMapLevels, unsigned int min_mip_map = 0);
 }
@@ -6,6 +6,8 @@
 #include <iostream>
 #include <format>
 #include <map>
+#include <string>
+#include <string_view>
 
 #include "Timer.h"
 
@@ -38,10 +40,15 @@ class ProfileBlock {
         }
 
         // Per string identifier, a pair containing the total time in nanoseconds and total increments
-        std::map<std::string, std::pair<uint64_t, uint32_t>> m_time_table;
+        // (transparent comparator, so looking up an existing key doesn't allocate a string)
+        std::map<std::string, std::pair<uint64_t, uint32_t>, std::less<>> m_time_table;
 
-        static ProfileBlock profile(const std::string& key) {
-            auto& [total, count] = get().m_time_table[key];
+        static ProfileBlock profile(std::string_view key) {
+            auto& table = get().m_time_table;
+            auto it = table.find(key);
+            if (it == table.end())
+                it = table.emplace(key, std::pair<uint64_t, uint32_t>{0u, 0u}).first;
+            auto& [total, count] = it->second;
             ++count;
             return ProfileBlock{total};
         }
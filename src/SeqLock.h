@@ -0,0 +1,100 @@
+#ifndef MOLUMES_SEQLOCK_H
+#define MOLUMES_SEQLOCK_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+namespace molumes {
+    /**
+     * @brief Sequence lock for sharing a small struct with a real-time thread
+     *
+     * Readers never block and never write to shared memory: load() copies the whole value and retries if a write
+     * happened in the meantime. Writers are serialized by a mutex, so there can be any number of writers, but they
+     * should be rare compared to the reads (a reader retries for as long as a write is in progress).
+     *
+     * The value is stored as relaxed atomic words, so the racy copy of the reader is well defined. This requires T to
+     * be trivially copyable.
+     *
+     * Example usage:
+     * @code settings.update([](auto &s) { s.surface_force = 4.f; });
+     * @code const auto snapshot = settings.load();
+     */
+    template<typename T>
+    class SeqLock {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        using Word = std::uint64_t;
+        static constexpr std::size_t WordCount = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+
+        std::atomic<std::uint64_t> m_sequence{0};
+        std::array<std::atomic<Word>, WordCount> m_words{};
+        std::mutex m_write_mutex;
+
+        // Assumes the caller holds the write mutex
+        void write(const T &value) {
+            std::array<Word, WordCount> words{};
+            std::memcpy(words.data(), &value, sizeof(T));
+
+            const auto sequence = m_sequence.load(std::memory_order_relaxed);
+            // Odd sequence number marks a write in progress
+            m_sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (std::size_t i{0}; i < WordCount; ++i)
+                m_words[i].store(words[i], std::memory_order_relaxed);
+            m_sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        // Assumes the caller holds the write mutex, so the value can't change while it's read
+        T read_locked() const {
+            std::array<Word, WordCount> words{};
+            for (std::size_t i{0}; i < WordCount; ++i)
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            T value;
+            std::memcpy(static_cast<void *>(&value), words.data(), sizeof(T));
+            return value;
+        }
+
+    public:
+        explicit SeqLock(const T &value = {}) { write(value); }
+
+        SeqLock(const SeqLock &) = delete;
+        SeqLock &operator=(const SeqLock &) = delete;
+
+        /// Consistent copy of the latest stored value. Lock-free and allocation-free.
+        T load() const {
+            std::array<Word, WordCount> words{};
+            std::uint64_t before, after;
+            do {
+                before = m_sequence.load(std::memory_order_acquire);
+                for (std::size_t i{0}; i < WordCount; ++i)
+                    words[i] = m_words[i].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                after = m_sequence.load(std::memory_order_relaxed);
+            } while (before != after || (before & 1u) != 0);
+
+            T value;
+            std::memcpy(static_cast<void *>(&value), words.data(), sizeof(T));
+            return value;
+        }
+
+        void store(const T &value) {
+            std::lock_guard guard{m_write_mutex};
+            write(value);
+        }
+
+        /// Read-modify-write of the value, func is called with a reference to a copy of the current value
+        template<typename F>
+        void update(F &&func) {
+            std::lock_guard guard{m_write_mutex};
+            auto value = read_locked();
+            func(value);
+            write(value);
+        }
+    };
+}
+
+#endif //MOLUMES_SEQLOCK_H
@@ -0,0 +1,188 @@
+#include "TextureSampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MOLUMES_SAMPLER_SSE
+
+#include <emmintrin.h>
+
+#endif
+
+using namespace molumes;
+
+namespace {
+    constexpr std::size_t CacheLineSize = 64;
+    // Levels with fewer texels are converted on the calling thread, as starting the threads costs more than it gains
+    constexpr std::size_t MinParallelTexels = 1u << 14;
+
+    // Resizes storage to fit count elements starting at a cache line boundary, and returns that start
+    template<typename T>
+    T *cache_aligned(std::vector<T> &storage, std::size_t count) {
+        storage.resize(count + CacheLineSize / sizeof(T));
+        const auto address = reinterpret_cast<std::uintptr_t>(storage.data());
+        return storage.data() + (CacheLineSize - address % CacheLineSize) % CacheLineSize / sizeof(T);
+    }
+}
+
+std::array<std::size_t, 4> SampledTexture::footprint(std::size_t x0, std::size_t y0) const {
+    const auto x1 = std::min<std::size_t>(x0 + 1, m_dims.x - 1);
+    const auto y1 = std::min<std::size_t>(y0 + 1, m_dims.y - 1);
+    return {texel_index(x0, y0), texel_index(x1, y0), texel_index(x0, y1), texel_index(x1, y1)};
+}
+
+glm::vec2 SampledTexture::texel_coord(const glm::vec2 &uv) const {
+    const auto coord = uv * m_uv_scale + m_uv_offset;
+    // std::max(0, NaN) is 0, so NaN coordinates are clamped as well
+    return {std::min(std::max(0.f, coord.x), m_max_coord.x), std::min(std::max(0.f, coord.y), m_max_coord.y)};
+}
+
+glm::vec4 SampledTexture::sample(const glm::vec2 &uv) const {
+    if (empty())
+        return glm::vec4{0.f};
+
+    const auto coord = texel_coord(uv);
+    const auto x0 = static_cast<std::size_t>(coord.x);
+    const auto y0 = static_cast<std::size_t>(coord.y);
+    const auto indices = footprint(x0, y0);
+    const glm::vec2 f{coord.x - static_cast<float>(x0), coord.y - static_cast<float>(y0)};
+#ifdef MOLUMES_SAMPLER_SSE
+    const auto aa = _mm_loadu_ps(&m_texels[indices[0]].x);
+    const auto ba = _mm_loadu_ps(&m_texels[indices[1]].x);
+    const auto ab = _mm_loadu_ps(&m_texels[indices[2]].x);
+    const auto bb = _mm_loadu_ps(&m_texels[indices[3]].x);
+    const auto fx = _mm_set1_ps(f.x);
+    const auto a = _mm_add_ps(aa, _mm_mul_ps(_mm_sub_ps(ba, aa), fx));
+    const auto b = _mm_add_ps(ab, _mm_mul_ps(_mm_sub_ps(bb, ab), fx));
+    const auto s = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(f.y)));
+    // Any NaN component makes the whole sample 0
+    if (_mm_movemask_ps(_mm_cmpunord_ps(s, s)) != 0)
+        return glm::vec4{0.f};
+    glm::vec4 out;
+    _mm_storeu_ps(&out.x, s);
+    return out;
+#else
+    const auto a = glm::mix(m_texels[indices[0]], m_texels[indices[1]], f.x);
+    const auto b = glm::mix(m_texels[indices[2]], m_texels[indices[3]], f.x);
+    const auto s = glm::mix(a, b, f.y);
+    return std::isnan(s.x) || std::isnan(s.y) || std::isnan(s.z) || std::isnan(s.w) ? glm::vec4{0.f} : s;
+#endif
+}
+
+float SampledTexture::sample_height(const glm::vec2 &uv) const {
+    if (empty())
+        return 0.f;
+
+    const auto coord = texel_coord(uv);
+    const auto x0 = static_cast<std::size_t>(coord.x);
+    const auto y0 = static_cast<std::size_t>(coord.y);
+    const auto indices = footprint(x0, y0);
+    const glm::vec2 f{coord.x - static_cast<float>(x0), coord.y - static_cast<float>(y0)};
+    const auto s = std::lerp(
+            std::lerp(m_heights[indices[0]], m_heights[indices[1]], f.x),
+            std::lerp(m_heights[indices[2]], m_heights[indices[3]], f.x),
+            f.y);
+    return std::isnan(s) ? 0.f : s;
+}
+
+std::array<float, 4> SampledTexture::gather_heights(const std::array<glm::vec2, 4> &uvs) const {
+    if (empty())
+        return {};
+
+    alignas(16) std::array<float, 4> out;
+#ifdef MOLUMES_SAMPLER_SSE
+    // One tap per lane, from the texel coordinates to the final interpolation
+    const auto u = _mm_setr_ps(uvs[0].x, uvs[1].x, uvs[2].x, uvs[3].x);
+    const auto v = _mm_setr_ps(uvs[0].y, uvs[1].y, uvs[2].y, uvs[3].y);
+    // _mm_max_ps returns the second operand for NaN, so NaN coordinates are clamped to 0
+    const auto x = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(u, _mm_set1_ps(m_uv_scale.x)),
+                                                    _mm_set1_ps(m_uv_offset.x)), _mm_setzero_ps()),
+                              _mm_set1_ps(m_max_coord.x));
+    const auto y = _mm_min_ps(_mm_max_ps(_mm_mul_ps(v, _mm_set1_ps(m_uv_scale.y)), _mm_setzero_ps()),
+                              _mm_set1_ps(m_max_coord.y));
+    const auto x0 = _mm_cvttps_epi32(x);
+    const auto y0 = _mm_cvttps_epi32(y);
+    const auto fx = _mm_sub_ps(x, _mm_cvtepi32_ps(x0));
+    const auto fy = _mm_sub_ps(y, _mm_cvtepi32_ps(y0));
+
+    alignas(16) std::array<std::int32_t, 4> ix, iy;
+    _mm_store_si128(reinterpret_cast<__m128i *>(ix.data()), x0);
+    _mm_store_si128(reinterpret_cast<__m128i *>(iy.data()), y0);
+
+    // Heights of the 4 corner texels of every tap
+    alignas(16) std::array<float, 4> aa, ba, ab, bb;
+    for (std::size_t i = 0; i < 4; ++i) {
+        const auto indices = footprint(static_cast<std::size_t>(ix[i]), static_cast<std::size_t>(iy[i]));
+        aa[i] = m_heights[indices[0]];
+        ba[i] = m_heights[indices[1]];
+        ab[i] = m_heights[indices[2]];
+        bb[i] = m_heights[indices[3]];
+    }
+
+    const auto vaa = _mm_load_ps(aa.data());
+    const auto vab = _mm_load_ps(ab.data());
+    const auto a = _mm_add_ps(vaa, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(ba.data()), vaa), fx));
+    const auto b = _mm_add_ps(vab, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(bb.data()), vab), fx));
+    const auto s = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), fy));
+    // NaN lanes are set to 0
+    _mm_store_ps(out.data(), _mm_and_ps(s, _mm_cmpord_ps(s, s)));
+#else
+    for (std::size_t i = 0; i < 4; ++i)
+        out[i] = sample_height(uvs[i]);
+#endif
+    return out;
+}
+
+void SampledMipPyramid::assign(const MipPyramid &pyramid) {
+    constexpr auto TileSize = SampledTexture::TileSize;
+    constexpr auto TileTexels = std::size_t{TileSize} * TileSize;
+
+    // Every level is padded to whole tiles, the padding is never read as texel coordinates are clamped
+    std::array<std::size_t, MipPyramid::LevelCount> offsets{};
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < MipPyramid::LevelCount; ++i) {
+        const auto dims = pyramid.dims(i);
+        const auto tiles = glm::uvec2{(dims.x + TileSize - 1) / TileSize, (dims.y + TileSize - 1) / TileSize};
+        offsets[i] = total;
+        total += std::size_t{tiles.x} * tiles.y * TileTexels;
+    }
+    auto *const texels = cache_aligned(m_texels, total);
+    auto *const heights = cache_aligned(m_heights, total);
+
+    for (std::size_t i = 0; i < MipPyramid::LevelCount; ++i) {
+        auto &level = m_levels[i];
+        const auto dims = pyramid.dims(i);
+        if (dims.x == 0 || dims.y == 0) {
+            level = SampledTexture{};
+            continue;
+        }
+
+        level.m_texels = texels + offsets[i];
+        level.m_heights = heights + offsets[i];
+        level.m_dims = dims;
+        level.m_tiles_x = (dims.x + TileSize - 1) / TileSize;
+
+        const auto size = glm::vec2{dims};
+        const float x_min = 0.5f - size.y / (size.x + size.x);
+        level.m_uv_scale = glm::vec2{(1.f - x_min - x_min) * (size.x + 1.f), size.y + 1.f};
+        level.m_uv_offset = glm::vec2{x_min * (size.x + 1.f), 0.f};
+        level.m_max_coord = size - 1.f;
+
+        // Every row writes its own texels, so the rows are independent
+        const auto src = pyramid.level(i);
+#pragma omp parallel for schedule(static) if (static_cast<std::size_t>(dims.x) * dims.y >= MinParallelTexels)
+        for (int y = 0; y < static_cast<int>(dims.y); y++) {
+            const auto *row = src.data() + static_cast<std::size_t>(y) * dims.x;
+            for (std::size_t x = 0; x < dims.x; ++x) {
+                const auto &t = row[x];
+                const auto index = offsets[i] + level.texel_index(x, static_cast<std::size_t>(y));
+                texels[index] = {t.x * 2.f - 1.f, t.y * 2.f - 1.f, t.z * 2.f - 1.f, t.w};
+                heights[index] = t.w;
+            }
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef MOLUMES_TEXTURESAMPLER_H
+#define MOLUMES_TEXTURESAMPLER_H
+
+#include "Constants.h"
+#include "MipPyramid.h"
+
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <array>
+#include <vector>
+
+namespace molumes {
+    /**
+     * @brief Normal and height texture prepared for sampling on the CPU (in the haptic loop)
+     *
+     * A view of one level of a SampledMipPyramid. Texels are stored with the normal already mapped from [0, 1] to
+     * [-1, 1] (the height in w is kept as is), so a sample is only the bilinear interpolation of 4 texels. Texel
+     * addresses are clamped to the texture, so sampling never needs bounds checks and the edge texels extend outwards.
+     * Interpolation uses SSE when available. Sampling doesn't allocate.
+     *
+     * Texels are stored in 4x4 tiles (tiles row by row, texels inside a tile row by row). The heights are additionally
+     * stored on their own, where a tile is exactly one cache line, so the 2x2 texels of a height sample and the taps of
+     * a gradient kernel mostly share cache lines, instead of touching a line per texel row.
+     */
+    class SampledTexture {
+    public:
+        static constexpr unsigned int TileSize = 4;
+
+        [[nodiscard]] bool empty() const { return m_texels == nullptr; }
+
+        [[nodiscard]] glm::uvec2 dims() const { return m_dims; }
+
+        /// Bilinear sample of the normalized normal (xyz) and height (w), 0 for an empty texture or on NaN
+        [[nodiscard]] glm::vec4 sample(const glm::vec2 &uv) const;
+
+        /// Same as sample(), but only the height
+        [[nodiscard]] float sample_height(const glm::vec2 &uv) const;
+
+        /// Heights of 4 taps at once (e.g. the central differences of a gradient), interpolated 4-wide
+        [[nodiscard]] std::array<float, 4> gather_heights(const std::array<glm::vec2, 4> &uvs) const;
+
+        // Index of texel (x, y) in the tiled storage
+        [[nodiscard]] std::size_t texel_index(std::size_t x, std::size_t y) const {
+            return ((y / TileSize) * m_tiles_x + x / TileSize) * (TileSize * TileSize) + (y % TileSize) * TileSize +
+                   x % TileSize;
+        }
+
+    private:
+        friend class SampledMipPyramid;
+
+        const glm::vec4 *m_texels{nullptr};
+        const float *m_heights{nullptr};
+        glm::uvec2 m_dims{0u};
+        std::size_t m_tiles_x{0};
+
+        /**
+         * uv to texel coordinates: The textures are calculated in screen-space pixel coordinates, which is typically
+         * widescreen, so the u coordinate is mapped to the centered square part of the texture.
+         */
+        glm::vec2 m_uv_scale{0.f}, m_uv_offset{0.f};
+        // Largest texel coordinate, texel coordinates are clamped to [0, m_max_coord]
+        glm::vec2 m_max_coord{0.f};
+
+        // Texel coordinate of uv, clamped to the texture (NaN is mapped to 0)
+        [[nodiscard]] glm::vec2 texel_coord(const glm::vec2 &uv) const;
+
+        // Indices of the 4 texels around a clamped texel coordinate: (x0, y0), (x1, y0), (x0, y1), (x1, y1)
+        [[nodiscard]] std::array<std::size_t, 4> footprint(std::size_t x0, std::size_t y0) const;
+    };
+
+    /**
+     * @brief All mip map levels of a haptic texture, prepared for sampling, in one contiguous allocation (per plane)
+     *
+     * Not copyable, as the level views point into the pyramid's own storage.
+     */
+    class SampledMipPyramid {
+    public:
+        SampledMipPyramid() = default;
+
+        SampledMipPyramid(const SampledMipPyramid &) = delete;
+        SampledMipPyramid &operator=(const SampledMipPyramid &) = delete;
+
+        // Normalizes and tiles the texels of all levels. Reuses the previous memory when the size doesn't grow.
+        void assign(const MipPyramid &pyramid);
+
+        [[nodiscard]] const SampledTexture &at(std::size_t level) const { return m_levels.at(level); }
+
+    private:
+        std::array<SampledTexture, MipPyramid::LevelCount> m_levels{};
+        // Storage of all levels, each starting at a cache line boundary somewhere in the vector
+        std::vector<glm::vec4> m_texels;
+        std::vector<float> m_heights;
+    };
+}
+
+#endif //MOLUMES_TEXTURESAMPLER_H
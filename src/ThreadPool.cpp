@@ -0,0 +1,99 @@
+#include "ThreadPool.h"
+
+namespace molumes {
+    namespace {
+        // Pool and queue of the worker running on this thread, so jobs submitted from a job stay on its worker
+        thread_local const ThreadPool *currentPool = nullptr;
+        thread_local std::size_t currentWorker = 0;
+    }
+
+    ThreadPool::ThreadPool(unsigned int threadCount) {
+        threadCount = std::max(threadCount, 1u);
+        m_queues.reserve(threadCount);
+        for (unsigned int i{0}; i < threadCount; ++i)
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+
+        m_threads.reserve(threadCount);
+        for (std::size_t i{0}; i < threadCount; ++i)
+            m_threads.emplace_back(&ThreadPool::work, this, i);
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard{m_sleepMutex};
+            m_stopping = true;
+        }
+        m_wakeup.notify_all();
+
+        // Running jobs are finished, queued jobs are dropped together with the queues
+        for (auto &thread: m_threads)
+            if (thread.joinable())
+                thread.join();
+    }
+
+    ThreadPool &ThreadPool::global() {
+        static ThreadPool pool{};
+        return pool;
+    }
+
+    void ThreadPool::push(Job &&job) {
+        const auto queue = currentPool == this ? currentWorker :
+                           m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+        {
+            std::lock_guard<std::mutex> guard{m_queues[queue]->mutex};
+            m_queues[queue]->jobs.push_back(std::move(job));
+            // Counted while the job is queued, so the count is the number of queued jobs
+            std::lock_guard<std::mutex> sleepGuard{m_sleepMutex};
+            ++m_pendingJobs;
+        }
+        m_wakeup.notify_one();
+    }
+
+    bool ThreadPool::pop(std::size_t worker, Job &job) {
+        // Newest job of the own queue first, it's the most likely to still be in cache
+        {
+            auto &own = *m_queues[worker];
+            std::lock_guard<std::mutex> guard{own.mutex};
+            if (!own.jobs.empty()) {
+                job = std::move(own.jobs.back());
+                own.jobs.pop_back();
+                std::lock_guard<std::mutex> sleepGuard{m_sleepMutex};
+                --m_pendingJobs;
+                return true;
+            }
+        }
+
+        // Otherwise steal the oldest job of another worker
+        for (std::size_t i{1}; i < m_queues.size(); ++i) {
+            auto &other = *m_queues[(worker + i) % m_queues.size()];
+            std::lock_guard<std::mutex> guard{other.mutex};
+            if (!other.jobs.empty()) {
+                job = std::move(other.jobs.front());
+                other.jobs.pop_front();
+                std::lock_guard<std::mutex> sleepGuard{m_sleepMutex};
+                --m_pendingJobs;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::work(std::size_t worker) {
+        currentPool = this;
+        currentWorker = worker;
+
+        Job job;
+        while (true) {
+            if (pop(worker, job)) {
+                job();
+                job = {};
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock{m_sleepMutex};
+            m_wakeup.wait(lock, [this]() { return m_stopping || 0 < m_pendingJobs; });
+            if (m_stopping)
+                return;
+        }
+    }
+}
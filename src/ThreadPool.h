@@ -0,0 +1,216 @@
+#ifndef MOLUMES_THREADPOOL_H
+#define MOLUMES_THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace molumes {
+    /**
+     * @brief Read side of a cancellation flag, passed to background jobs
+     *
+     * Jobs check cancelled() at convenient points and stop early once it's set. A default constructed token is
+     * never cancelled.
+     */
+    class CancellationToken {
+    public:
+        CancellationToken() = default;
+
+        bool cancelled() const { return m_cancelled && m_cancelled->load(std::memory_order_relaxed); }
+
+    private:
+        friend class CancellationSource;
+
+        explicit CancellationToken(std::shared_ptr<const std::atomic<bool>> cancelled)
+                : m_cancelled{std::move(cancelled)} {}
+
+        std::shared_ptr<const std::atomic<bool>> m_cancelled;
+    };
+
+    /**
+     * @brief Owner side of a cancellation flag
+     *
+     * Cancels its tokens when cancel() is called, when it's destroyed and when another source is assigned to it, so
+     * replacing the source of an owner cancels every job started with the previous one.
+     */
+    class CancellationSource {
+    public:
+        CancellationSource() : m_cancelled{std::make_shared<std::atomic<bool>>(false)} {}
+
+        CancellationSource(const CancellationSource &) = delete;
+        CancellationSource &operator=(const CancellationSource &) = delete;
+
+        CancellationSource(CancellationSource &&other) noexcept = default;
+
+        CancellationSource &operator=(CancellationSource &&other) noexcept {
+            if (this != &other) {
+                cancel();
+                m_cancelled = std::move(other.m_cancelled);
+            }
+            return *this;
+        }
+
+        ~CancellationSource() { cancel(); }
+
+        CancellationToken token() const { return CancellationToken{m_cancelled}; }
+
+        void cancel() {
+            if (m_cancelled)
+                m_cancelled->store(true, std::memory_order_relaxed);
+        }
+
+        bool cancelled() const { return !m_cancelled || m_cancelled->load(std::memory_order_relaxed); }
+
+    private:
+        std::shared_ptr<std::atomic<bool>> m_cancelled;
+    };
+
+    /**
+     * @brief Work-stealing thread pool for background jobs
+     *
+     * Every worker thread has its own job queue. Jobs submitted from outside of the pool are spread over the queues,
+     * jobs submitted from inside of a job go to the queue of that worker. A worker takes the newest job of its own
+     * queue and, when that is empty, steals the oldest job of another queue. Idle workers sleep on a condition
+     * variable until a job is submitted.
+     *
+     * Jobs are run with copies of their arguments and the result (or exception) is returned through a std::future.
+     * Jobs that are still queued when the pool is destroyed are dropped, which leaves their futures with a
+     * std::future_error (broken promise).
+     *
+     * Example usage:
+     * @code auto result = ThreadPool::global().submit(func, func_parameters...);
+     */
+    class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned int threadCount = std::max(std::thread::hardware_concurrency(), 1u));
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        ~ThreadPool();
+
+        /// The pool shared by the whole application
+        static ThreadPool &global();
+
+        std::size_t threadCount() const { return m_threads.size(); }
+
+        /**
+         * @brief Queue a function, with parameters, to be run by the pool
+         * @param func - Function to be run
+         * @param args - Function arguments the function should be invoked with (copied or moved into the job)
+         * @return A future holding the return value of the function once it completes
+         */
+        template<typename F, typename ... Args>
+        auto submit(F &&func, Args &&... args) {
+            using R = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+            std::packaged_task<R()> task{
+                    [func = std::forward<F>(func), ... args = std::forward<Args>(args)]() mutable {
+                        return std::invoke(std::move(func), std::move(args)...);
+                    }};
+            auto result = task.get_future();
+            push(Job{[task = std::move(task)]() mutable { task(); }});
+            return result;
+        }
+
+    private:
+        using Job = std::packaged_task<void()>;
+
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+        std::vector<std::thread> m_threads;
+        std::atomic<std::size_t> m_nextQueue{0};
+
+        // Queued jobs are counted under the sleep mutex (taken inside a queue mutex) so that a worker can't miss a
+        // wakeup, and sleeps whenever every queue is empty
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wakeup;
+        std::size_t m_pendingJobs{0};
+        bool m_stopping{false};
+
+        void push(Job &&job);
+
+        bool pop(std::size_t worker, Job &job);
+
+        void work(std::size_t worker);
+    };
+
+    /**
+     * @brief A job type of which only the newest submission is run
+     *
+     * Submissions are run one after the other on a thread pool. A submission that hasn't started yet when a newer one
+     * arrives is dropped (its future reports a broken promise), so a burst of submissions, e.g. while a slider is
+     * dragged, only runs the job that is already running and the newest one.
+     */
+    template<typename R>
+    class CoalescingJob {
+    public:
+        explicit CoalescingJob(ThreadPool &pool = ThreadPool::global()) : m_pool{pool} {}
+
+        /// Same as ThreadPool::submit(), but replaces the pending submission of this job
+        template<typename F, typename ... Args>
+        std::future<R> submit(F &&func, Args &&... args) {
+            std::packaged_task<R()> task{
+                    [func = std::forward<F>(func), ... args = std::forward<Args>(args)]() mutable {
+                        return std::invoke(std::move(func), std::move(args)...);
+                    }};
+            auto result = task.get_future();
+
+            std::lock_guard<std::mutex> guard{m_state->mutex};
+            m_state->pending = std::move(task);
+            if (!m_state->scheduled) {
+                m_state->scheduled = true;
+                m_pool.submit(&run, m_state);
+            }
+            return result;
+        }
+
+    private:
+        struct State {
+            std::mutex mutex;
+            std::packaged_task<R()> pending;
+            // Whether a pool job is running (or queued) that will run the pending submission
+            bool scheduled{false};
+        };
+
+        static void run(const std::shared_ptr<State> &state) {
+            while (true) {
+                std::packaged_task<R()> task;
+                {
+                    std::lock_guard<std::mutex> guard{state->mutex};
+                    if (!state->pending.valid()) {
+                        state->scheduled = false;
+                        return;
+                    }
+                    task = std::move(state->pending);
+                }
+                task();
+            }
+        }
+
+        ThreadPool &m_pool;
+        // Shared with the pool job, so submissions can outlive the CoalescingJob
+        std::shared_ptr<State> m_state = std::make_shared<State>();
+    };
+
+    /// Waits for as little as it can and checks if the future is ready.
+    template<typename T>
+    bool isReady(const std::future<T> &f) {
+        return f.wait_for(std::chrono::nanoseconds{0}) == std::future_status::ready;
+    }
+}
+
+#endif //MOLUMES_THREADPOOL_H
@@ -0,0 +1,63 @@
+#ifndef MOLUMES_TRIPLEBUFFER_H
+#define MOLUMES_TRIPLEBUFFER_H
+
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace molumes {
+    /**
+     * @brief Triple buffer for handing the latest version of a large value to a real-time thread
+     *
+     * The writer fills the back buffer in place and then swaps it with the middle buffer. The reader swaps the middle
+     * buffer with its front buffer when the middle one is newer. Both swaps are a single atomic exchange of an index,
+     * so the reader never blocks or copies, and no buffer is written while the reader is using it. The buffers are
+     * reused, so a write only allocates if the value needs more memory than the buffer it overwrites.
+     *
+     * Writers are serialized by a mutex, so there can be any number of writers, but only one reader.
+     *
+     * Example usage:
+     * @code buffer.write([&](auto &value) { value.assign(source); });
+     * @code if (buffer.update()) use(buffer.front());
+     */
+    template<typename T>
+    class TripleBuffer {
+        // Set in m_middle while the middle buffer holds a value the reader hasn't taken yet
+        static constexpr unsigned int Fresh = 4u;
+
+        std::array<T, 3> m_buffers{};
+        std::atomic<unsigned int> m_middle{1};
+        // Only accessed by the reader
+        unsigned int m_front{0};
+        // Only accessed by the writers, while holding the write mutex
+        unsigned int m_back{2};
+        std::mutex m_write_mutex;
+
+    public:
+        TripleBuffer() = default;
+
+        TripleBuffer(const TripleBuffer &) = delete;
+        TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+        /// Calls func with a reference to the back buffer, which holds an older value, and publishes it afterwards
+        template<typename F>
+        void write(F &&func) {
+            std::lock_guard guard{m_write_mutex};
+            func(m_buffers[m_back]);
+            m_back = m_middle.exchange(m_back | Fresh, std::memory_order_acq_rel) & ~Fresh;
+        }
+
+        /// Makes the latest written value the front buffer, false if there is none newer. Lock-free and allocation-free.
+        bool update() {
+            if ((m_middle.load(std::memory_order_relaxed) & Fresh) == 0)
+                return false;
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & ~Fresh;
+            return true;
+        }
+
+        /// Value taken by the last update() (a default constructed T before that), only for the reader
+        [[nodiscard]] const T &front() const { return m_buffers[m_front]; }
+    };
+}
+
+#endif //MOLUMES_TRIPLEBUFFER_H
@@ -123,11 +123,11 @@ Viewer::Viewer(GLFWwindow *window, Scene *scene) : m_window(window), m_scene(sce
     glfwSetScrollCallback(window, &Viewer::scrollCallback);
 
 
-    using NormalTexType = std::array<std::pair<glm::uvec2, std::vector<glm::vec4>>, HapticMipMapLevels>;
-    ReaderChannel<NormalTexType> normal_tex_channel{};
+    // Written by the mip-map jobs of the tile renderer, read by the haptic loop
+    const auto normal_tex_buffer = std::make_shared<TripleBuffer<SampledMipPyramid>>();
 
     // Renderers:
-    m_renderers.emplace_back(std::make_unique<TileRenderer>(this, WriterChannel<NormalTexType>{normal_tex_channel}));
+    m_renderers.emplace_back(std::make_unique<TileRenderer>(this, normal_tex_buffer));
     const auto crystal_renderer_ptr = static_cast<CrystalRenderer *>(m_renderers.emplace_back(
             std::make_unique<CrystalRenderer>(this)).get());
     const auto haptic_renderer_ptr = static_cast<HapticRenderer *>(m_renderers.emplace_back(
@@ -140,7 +140,7 @@ Viewer::Viewer(GLFWwindow *window, Scene *scene) : m_window(window), m_scene(sce
     m_interactors.emplace_back(std::make_unique<CameraInteractor>(this));
     m_interactors.emplace_back(std::make_unique<STLExporter>(this, crystal_renderer_ptr))->setEnabled(false);
     const auto haptic_interactor_ptr = static_cast<HapticInteractor *>(m_interactors.emplace_back(
-            std::make_unique<HapticInteractor>(this, std::move(normal_tex_channel))).get());
+            std::make_unique<HapticInteractor>(this, normal_tex_buffer)).get());
 
 
     crystal_renderer_ptr->setEnabled(false);
@@ -819,7 +819,8 @@ void Viewer::openFile(const std::string &path) {
     if (filepath.empty()) {
         const auto rootPath = std::filesystem::current_path() / "dat";
         auto fileDialog = pfd::open_file("Open file", rootPath.string(),
-                                         {"Height-field images", "*.png *.jpg *.jpeg *.bmp", "CSV Files", "*.csv"},
+                                         {"Height-field images", "*.png *.jpg *.jpeg *.bmp", "CSV Files", "*.csv",
+                                          "Binary point clouds", "*.mpc"},
                                          pfd::opt::none);
         const auto result = fileDialog.result();
         if (result.empty())
@@ -833,7 +834,7 @@ void Viewer::openFile(const std::string &path) {
 
     const auto filename = filepath.string();
 
-    if (filepath.extension() == std::filesystem::path{".csv"}) {
+    if (Table::isTableFile(filename)) {
         // initialize table
         scene()->table()->load(filename);
     }
@@ -4,18 +4,27 @@
 #include "../Profile.h"
 #include "../DelegateUtils.h"
 #include "../Physics.h"
+#include "../AllocationCounter.h"
 
 #include <iostream>
 #include <format>
 #include <chrono>
 #include <future>
 #include <algorithm>
+#include <cfloat>
+#include <filesystem>
+#include <fstream>
 
 #include <glm/glm.hpp>
 #include <glm/gtx/string_cast.hpp>
 
 #include <imgui.h>
 
+// windows.h, which portable-file-dialogs includes, defines its own min/max operator which crashes with STL
+#define NOMINMAX
+
+#include <portable-file-dialogs.h>
+
 #ifdef DHD
 
 #include <dhdc.h>
@@ -49,26 +58,6 @@ struct std::formatter<glm::vec<L, T, Q>> : std::formatter<std::string> {
     }
 };
 
-std::pair<glm::uvec2, std::vector<glm::vec4>>
-HapticInteractor::generate_single_mipmap(glm::uvec2 tex_dims, std::vector<glm::vec4> tex_data) {
-    const auto new_dims = tex_dims / 2u;
-    // coord.y * tex_dims.x + coord.x
-    for (glm::uint y = 0; y < new_dims.y; ++y) {
-        for (glm::uint x = 0; x < new_dims.x; ++x) {
-            const auto sum = tex_data.at(2 * y * tex_dims.x + x * 2) +
-                             tex_data.at(2 * y * tex_dims.x + x * 2 + 1) +
-                             tex_data.at((2 * y + 1) * tex_dims.x + x * 2) +
-                             tex_data.at((2 * y + 1) * tex_dims.x + x * 2 + 1);
-            tex_data.at(y * new_dims.x + x) =
-                    sum * (0.25f/* * 1.5f*/); // Multiplied by 1.5 to strengthen further mipmap levels
-        }
-    }
-    tex_data.resize(tex_data.size() / 4);
-    tex_data.shrink_to_fit();
-
-    return std::make_pair(new_dims, std::move(tex_data));
-}
-
 #if defined(DHD) || defined(FAKE_HAPTIC)
 
 class HapticKeyHandler {
@@ -119,12 +108,12 @@ public:
 
 void haptic_loop(const std::stop_token &simulation_should_end, HapticInteractor::HapticParams &haptic_params,
                  std::promise<bool> &&setup_results,
-                 ReaderChannel<TextureMipMaps> &&normal_tex_channel) {
+                 std::shared_ptr<TripleBuffer<SampledMipPyramid>> normal_tex_buffer) {
     glm::dvec3 local_pos{0.0};
     bool force_enabled = false;
     double max_bound = 0.01;
-    TextureMipMaps normal_tex_mip_maps;
     constexpr double EPSILON = 0.001;
+    constexpr auto STATISTICS_INTERVAL = 250ms;
     auto last_t = chr::high_resolution_clock::now();
     // right = y, up = z, forward = -x
     // Converts from the Novint falcon's coordinate system (up=z), to our coordinate system (up=y)
@@ -138,19 +127,27 @@ void haptic_loop(const std::stop_token &simulation_should_end, HapticInteractor:
     // Novint Falcon keyboard layout: 0 - middle button, 1 - left button, 2 - top button, 3 - right button
     HapticKeyHandler key_handler{{0}};
     key_handler.add_on_changed_event(0, [&haptic_params](bool enabled) {
-        haptic_params.surface_volume_mode.store(enabled);
+        haptic_params.settings.update([enabled](auto &s) { s.surface_volume_mode = enabled; });
     });
     key_handler.add_on_changed_event(1, [&haptic_params](bool enabled) {
-        const auto cur = haptic_params.mip_map_level.load();
-        if (enabled && cur != 0)
-            haptic_params.mip_map_level.store(cur - 1);
+        haptic_params.settings.update([enabled](auto &s) {
+            if (enabled && s.mip_map_level != 0)
+                --s.mip_map_level;
+        });
     });
     key_handler.add_on_changed_event(3, [&haptic_params](bool enabled) {
-        const auto cur = haptic_params.mip_map_level.load();
-        if (enabled && cur != HapticMipMapLevels - 1)
-            haptic_params.mip_map_level.store(cur + 1);
+        haptic_params.settings.update([enabled](auto &s) {
+            if (enabled && s.mip_map_level != HapticMipMapLevels - 1)
+                ++s.mip_map_level;
+        });
     });
 
+    FixedRateScheduler scheduler{haptic_params.settings.load().loop_rate};
+    HapticInteractor::HapticLoopStatistics statistics{.allocations_counted = thread_allocation_count().has_value()};
+    auto last_statistics_t = chr::steady_clock::now();
+    std::optional<FixedRateScheduler::Clock::time_point> last_tick_t;
+    using Stage = HapticInteractor::HapticStage;
+
 #ifdef DHD
     // Initialize haptics device
     if (0 <= dhdOpen()) {
@@ -169,9 +166,22 @@ void haptic_loop(const std::stop_token &simulation_should_end, HapticInteractor:
 #endif
 
     while (!simulation_should_end.stop_requested()) {
+        const auto tick_t = scheduler.wait();
+        if (last_tick_t)
+            haptic_params.stage_latency(Stage::LoopPeriod).record(tick_t - *last_tick_t);
+        last_tick_t = tick_t;
+
+        // Everything from here until the end of the tick has to be allocation-free
+        const auto allocations_before = thread_allocation_count();
+
+        // All settings for this tick, read at once
+        const auto settings = haptic_params.settings.load();
+        scheduler.set_rate(settings.loop_rate);
+
         // Query for position (actual rate of querying from hardware is controlled by underlying SDK)
         {
             PROFILE("Haptic - Fetch position and velocity");
+            const auto latency = haptic_params.stage_latency(Stage::FetchPosition).scope();
 #ifdef DHD
             dhdGetPosition(&local_pos.x, &local_pos.y, &local_pos.z);
 
@@ -201,11 +211,9 @@ void haptic_loop(const std::stop_token &simulation_should_end, HapticInteractor:
             // Novint Falcon is in 10x10x10cm space = 0.1x0.1x0.1m = [-0.05, 0.05] m^3'
 
             // Scaling multiplication factor to be applied to local coordinates
-            const double scale_mult =
-                    haptic_params.interaction_bounds.load(std::memory_order_relaxed) /
-                    max_bound; // [0, max_bound] -> [0, 10]
+            const double scale_mult = settings.interaction_bounds / max_bound; // [0, max_bound] -> [0, 10]
 
-            world_pos = (haptic_params.input_space.load() == 0 ? glm::dmat3{1.0} : haptic_params.view_mat_inv.load()) *
+            world_pos = (settings.input_space == 0 ? glm::dmat3{1.0} : settings.view_mat_inv) *
                         (local_pos * scale_mult);
         }
 
@@ -216,8 +224,9 @@ void haptic_loop(const std::stop_token &simulation_should_end, HapticInteractor:
 
         {
             PROFILE("Haptic - Fetch normal tex");
-            if (normal_tex_channel.has_update())
-                normal_tex_mip_maps = normal_tex_channel.get();
+            const auto latency = haptic_params.stage_latency(Stage::FetchNormalTex).scope();
+            // Only swaps buffers, the mip-map jobs have already converted the pyramid for sampling
+            normal_tex_buffer->update();
         }
 
         // Simulation stuff
@@ -225,25 +234,18 @@ void haptic_loop(const std::stop_token &simulation_should_end, HapticInteractor:
         glm::dvec3 world_force{0.0};
         {
             PROFILE("Haptic - Sample force");
+            const auto latency = haptic_params.stage_latency(Stage::SampleForce).scope();
             world_force = physics_simulation.simulate_and_sample_force(
-                    haptic_params.surface_force.load(), haptic_params.surface_softness.load(),
-                    haptic_params.surface_height_multiplier.load(), haptic_params.mip_map_level.load(),
-                    normal_tex_mip_maps, world_pos, haptic_params.enable_friction.load()
-                                                    ? std::make_optional(
-                                    haptic_params.friction_scale.load())
-                                                    : std::nullopt,
-                    haptic_params.gravity_factor.load(), haptic_params.surface_volume_mode.load()
-                                                         ? std::make_optional(
-                                    haptic_params.surface_volume_mip_map_count.load())
-                                                         : std::nullopt,
-                    haptic_params.monte_carlo_sampling.load()
-                    ? std::make_optional(
-                            haptic_params.sphere_kernel_radius.load())
-                    : std::nullopt,
-                    haptic_params.volume_use_height_differences.load(),
-                    haptic_params.mip_map_scale_multiplier.load(),
-                    haptic_params.pre_interpolative_normals.load(),
-                    haptic_params.intersection_constraint.load());
+                    settings.surface_force, settings.surface_softness, settings.surface_height_multiplier,
+                    settings.mip_map_level, normal_tex_buffer->front(), world_pos,
+                    settings.enable_friction ? std::make_optional(settings.friction_scale) : std::nullopt,
+                    settings.enable_gravity ? std::make_optional(settings.gravity_factor) : std::nullopt,
+                    settings.surface_volume_mode ? std::make_optional(settings.surface_volume_mip_map_count)
+                                                 : std::nullopt,
+                    settings.monte_carlo_sampling ? std::make_optional(settings.sphere_kernel_radius)
+                                                  : std::nullopt,
+                    settings.volume_use_height_differences, settings.mip_map_scale_multiplier,
+                    settings.pre_interpolative_normals, settings.intersection_constraint);
         }
 
         {
@@ -260,44 +262,58 @@ void haptic_loop(const std::stop_token &simulation_should_end, HapticInteractor:
         }
 #endif
 
+        bool force_toggled = false;
         if (force_enabled) {
-            if (!haptic_params.enable_force.load()) {
+            if (!settings.enable_force) {
 #ifdef DHD
                 dhdSetForce(0.0, 0.0, 0.0);
                 dhdEnableForce(DHD_OFF);
 #endif
                 force_enabled = false;
-                std::cout << "Force disabled!" << std::endl;
+                force_toggled = true;
             }
         } else {
             // Wait to apply force until we've arrived at a safe space
-            if (haptic_params.enable_force.load() && glm::length(world_force) < EPSILON) {
+            if (settings.enable_force && glm::length(world_force) < EPSILON) {
 #ifdef DHD
                 dhdEnableForce(DHD_ON);
 #endif
                 force_enabled = true;
-                std::cout << "Force enabled!" << std::endl;
+                force_toggled = true;
             }
         }
 
-        if (!force_enabled)
-            continue;
-
-
 #ifdef DHD
-        {
+        if (force_enabled) {
             PROFILE("Haptic - Set force");
+            const auto latency = haptic_params.stage_latency(Stage::SetForce).scope();
             // Convert force from world space into the space of the haptic device
-            const auto haptic_force = local_to_haptic * (haptic_params.input_space.load() == 0 ? glm::dmat3{1.0}
-                                                                                               : haptic_params.view_mat.load()) *
-                                      world_force;
+            const auto haptic_force =
+                    local_to_haptic * (settings.input_space == 0 ? glm::dmat3{1.0} : settings.view_mat) * world_force;
             dhdSetForce(haptic_force.x, haptic_force.y, haptic_force.z);
         }
 #endif
 
-#ifdef FAKE_DHD
-        std::this_thread::sleep_for(1us);
-#endif
+        // End of the tick, anything below may allocate
+        if (allocations_before) {
+            const auto tick_allocations = *thread_allocation_count() - *allocations_before;
+            if (0 < tick_allocations && statistics.ticks_with_allocations == 0)
+                std::cout << std::format("Haptic loop allocated {} time(s) during tick {}!", tick_allocations,
+                                         statistics.ticks) << std::endl;
+            statistics.ticks_with_allocations += 0 < tick_allocations ? 1 : 0;
+            statistics.allocations += tick_allocations;
+        }
+        ++statistics.ticks;
+
+        if (force_toggled)
+            std::cout << (force_enabled ? "Force enabled!" : "Force disabled!") << std::endl;
+
+        if (STATISTICS_INTERVAL <= tick_t - last_statistics_t) {
+            last_statistics_t = tick_t;
+            statistics.scheduler = scheduler.statistics();
+            scheduler.reset_statistics();
+            haptic_params.statistics.store(statistics);
+        }
     }
 
 #ifdef DHD
@@ -310,12 +326,13 @@ void haptic_loop(const std::stop_token &simulation_should_end, HapticInteractor:
 
 #endif // DHD
 
-HapticInteractor::HapticInteractor(Viewer *viewer, ReaderChannel<TextureMipMaps> &&normal_tex_channel)
-        : Interactor(viewer), m_ui_surface_height_multiplier{m_params.surface_height_multiplier.load()},
-          m_ui_sphere_kernel_size{m_params.sphere_kernel_radius.load()},
-          m_ui_mip_map_scale_multiplier{m_params.mip_map_scale_multiplier.load()},
-          m_ui_surface_volume_enabled_mip_maps{generate_enabled_mip_maps(m_params.surface_volume_mip_map_count.load(),
-                                                                         m_params.mip_map_level.load())} {
+HapticInteractor::HapticInteractor(Viewer *viewer, std::shared_ptr<TripleBuffer<SampledMipPyramid>> normal_tex_buffer)
+        : Interactor(viewer), m_ui_surface_height_multiplier{m_params.settings.load().surface_height_multiplier},
+          m_ui_sphere_kernel_size{m_params.settings.load().sphere_kernel_radius},
+          m_ui_mip_map_scale_multiplier{m_params.settings.load().mip_map_scale_multiplier},
+          m_ui_surface_volume_enabled_mip_maps{
+                  generate_enabled_mip_maps(m_params.settings.load().surface_volume_mip_map_count,
+                                            m_params.settings.load().mip_map_level)} {
 #ifdef DHD
     std::cout << std::format("Running dhd SDK version {}", dhdGetSDKVersionStr()) << std::endl;
 
@@ -326,7 +343,7 @@ HapticInteractor::HapticInteractor(Viewer *viewer, ReaderChannel<TextureMipMaps>
 #if defined(DHD) || defined(FAKE_HAPTIC)
     std::promise<bool> setup_results{};
     auto haptics_enabled = setup_results.get_future();
-    m_thread = std::jthread{haptic_loop, std::ref(m_params), std::move(setup_results), std::move(normal_tex_channel)};
+    m_thread = std::jthread{haptic_loop, std::ref(m_params), std::move(setup_results), std::move(normal_tex_buffer)};
     m_haptic_enabled = haptics_enabled.get();
 #endif
 }
@@ -345,12 +362,11 @@ void HapticInteractor::keyEvent(int key, int scancode, int action, int mods) {
     const auto dec = int{action == GLFW_RELEASE};
 
     if (key == GLFW_KEY_F && action == GLFW_PRESS)
-        m_params.enable_force.store(!m_params.enable_force.load());
+        m_params.settings.update([](auto &s) { s.enable_force = !s.enable_force; });
     else if (key == GLFW_KEY_U && action == GLFW_PRESS)
-        m_params.enable_friction.store(!m_params.enable_friction.load());
+        m_params.settings.update([](auto &s) { s.enable_friction = !s.enable_friction; });
     else if (key == GLFW_KEY_G && action == GLFW_PRESS)
-        m_params.gravity_factor.store(m_params.gravity_factor.load().has_value() ? std::nullopt : std::make_optional(
-                m_ui_gravity_factor_value));
+        m_params.settings.update([](auto &s) { s.enable_gravity = !s.enable_gravity; });
 #ifndef NDEBUG
     else if (key == GLFW_KEY_P && action == GLFW_PRESS)
         Profiler::reset_profiler();
@@ -377,79 +393,96 @@ void HapticInteractor::keyEvent(int key, int scancode, int action, int mods) {
 void HapticInteractor::display() {
     Interactor::display();
 
-    auto mip_map_level = static_cast<int>(m_params.mip_map_level.load());
+    auto settings = m_params.settings.load();
+    // Only the changed field is written back, so changes made by the haptic thread in the meantime are kept
+    const auto set = [this](auto HapticSettings::*field, auto value) {
+        m_params.settings.update([field, value](HapticSettings &s) { s.*field = value; });
+    };
+
+    auto mip_map_level = static_cast<int>(settings.mip_map_level);
     bool enabled_mip_maps_changed = false;
     auto old_ui_surface_volume_mode = m_ui_surface_volume_mode;
 
     if (ImGui::BeginMenu("Haptics")) {
-        auto interaction_bounds = m_params.interaction_bounds.load();
-        auto enable_force = m_params.enable_force.load();
-        auto normal_force = m_params.surface_force.load();
-        auto softness = m_params.surface_softness.load();
-        m_ui_sphere_kernel_size = m_params.sphere_kernel_radius.load();
-        bool enable_friction = m_params.enable_friction.load();
-        float friction_scale = m_params.friction_scale.load();
-        m_ui_surface_height_multiplier = m_params.surface_height_multiplier.load();
-        int input_space = static_cast<int>(m_params.input_space.load());
-        bool gravity_enabled = m_params.gravity_factor.load().has_value();
-        int surface_volume_mip_map_count = static_cast<int>(m_params.surface_volume_mip_map_count.load());
-        auto monte_carlo_sampling = m_params.monte_carlo_sampling.load();
-        auto volume_use_height_diffs = m_params.volume_use_height_differences.load();
-        int normal_interpolation = static_cast<int>(m_params.pre_interpolative_normals.load());
-        bool intersection_constraint = m_params.intersection_constraint.load();
-
-        if (ImGui::SliderFloat("Interaction bounds", &interaction_bounds, 0.1f, 10.f))
-            m_params.interaction_bounds.store(interaction_bounds);
+        m_ui_sphere_kernel_size = settings.sphere_kernel_radius;
+        m_ui_surface_height_multiplier = settings.surface_height_multiplier;
+        int input_space = static_cast<int>(settings.input_space);
+        int surface_volume_mip_map_count = static_cast<int>(settings.surface_volume_mip_map_count);
+        int normal_interpolation = static_cast<int>(settings.pre_interpolative_normals);
+
+        if (ImGui::SliderFloat("Interaction bounds", &settings.interaction_bounds, 0.1f, 10.f))
+            set(&HapticSettings::interaction_bounds, settings.interaction_bounds);
         enabled_mip_maps_changed = ImGui::SliderInt("Mip map level", &mip_map_level, 0, HapticMipMapLevels - 1);
 
         if (ImGui::SliderFloat("Surface height multiplier", &m_ui_surface_height_multiplier, 0.01f, 2.f)) {
-            m_params.surface_height_multiplier.store(m_ui_surface_height_multiplier);
+            set(&HapticSettings::surface_height_multiplier, m_ui_surface_height_multiplier);
             viewer()->BROADCAST(&HapticInteractor::m_ui_surface_height_multiplier);
         }
-        if (ImGui::Checkbox("Enable force (F)", &enable_force))
-            m_params.enable_force.store(enable_force);
-        if (ImGui::SliderFloat("Soft surface-ness", &softness, 0.f, 0.4f))
-            m_params.surface_softness.store(softness);
-        if (ImGui::SliderFloat("Surface force (in Newtons)", &normal_force, 0.f, 9.f))
-            m_params.surface_force.store(normal_force);
-        if (ImGui::Checkbox("Gravity", &gravity_enabled) ||
-            (gravity_enabled && ImGui::SliderFloat("Gravity factor", &m_ui_gravity_factor_value, 0.f, 10.f)))
-            m_params.gravity_factor.store(
-                    gravity_enabled ? std::make_optional(m_ui_gravity_factor_value) : std::nullopt);
-        if (ImGui::Checkbox("Friction", &enable_friction))
-            m_params.enable_friction.store(enable_friction);
-        if (enable_friction && ImGui::SliderFloat("Friction scale", &friction_scale, 0.f, 1.f))
-            m_params.friction_scale.store(friction_scale);
+        if (ImGui::Checkbox("Enable force (F)", &settings.enable_force))
+            set(&HapticSettings::enable_force, settings.enable_force);
+        if (ImGui::SliderFloat("Soft surface-ness", &settings.surface_softness, 0.f, 0.4f))
+            set(&HapticSettings::surface_softness, settings.surface_softness);
+        if (ImGui::SliderFloat("Surface force (in Newtons)", &settings.surface_force, 0.f, 9.f))
+            set(&HapticSettings::surface_force, settings.surface_force);
+        if (ImGui::Checkbox("Gravity", &settings.enable_gravity))
+            set(&HapticSettings::enable_gravity, settings.enable_gravity);
+        if (settings.enable_gravity && ImGui::SliderFloat("Gravity factor", &settings.gravity_factor, 0.f, 10.f))
+            set(&HapticSettings::gravity_factor, settings.gravity_factor);
+        if (ImGui::Checkbox("Friction", &settings.enable_friction))
+            set(&HapticSettings::enable_friction, settings.enable_friction);
+        if (settings.enable_friction && ImGui::SliderFloat("Friction scale", &settings.friction_scale, 0.f, 1.f))
+            set(&HapticSettings::friction_scale, settings.friction_scale);
         if (ImGui::Combo("Input space", &input_space, "XZ-Aligned\0Camera Aligned"))
-            m_params.input_space.store(input_space);
+            set(&HapticSettings::input_space, static_cast<unsigned int>(input_space));
         ImGui::Checkbox("Surface volume mode", &m_ui_surface_volume_mode);
         if (m_ui_surface_volume_mode) {
             if (ImGui::SliderInt("Surface volume mip map count", &surface_volume_mip_map_count, 2,
                                  HapticMipMapLevels)) {
-                m_params.surface_volume_mip_map_count.store(static_cast<unsigned int>(surface_volume_mip_map_count));
+                set(&HapticSettings::surface_volume_mip_map_count,
+                    static_cast<unsigned int>(surface_volume_mip_map_count));
                 enabled_mip_maps_changed |= true;
             }
-            if (ImGui::Checkbox("Volume: Use height differences?", &volume_use_height_diffs))
-                m_params.volume_use_height_differences.store(volume_use_height_diffs);
+            if (ImGui::Checkbox("Volume: Use height differences?", &settings.volume_use_height_differences))
+                set(&HapticSettings::volume_use_height_differences, settings.volume_use_height_differences);
             if (ImGui::SliderFloat("Mip map scale multiplier", &m_ui_mip_map_scale_multiplier, 1.f, 3.f)) {
-                m_params.mip_map_scale_multiplier.store(m_ui_mip_map_scale_multiplier);
+                set(&HapticSettings::mip_map_scale_multiplier, m_ui_mip_map_scale_multiplier);
                 viewer()->BROADCAST(&HapticInteractor::m_ui_mip_map_scale_multiplier);
             }
         }
-        if (ImGui::Checkbox("Monte Carlo Sampling", &monte_carlo_sampling)) {
-            m_params.monte_carlo_sampling.store(monte_carlo_sampling);
+        if (ImGui::Checkbox("Monte Carlo Sampling", &settings.monte_carlo_sampling)) {
+            set(&HapticSettings::monte_carlo_sampling, settings.monte_carlo_sampling);
         }
-        if (monte_carlo_sampling && ImGui::DragFloat("Sampling radius", &m_ui_sphere_kernel_size, 0.0001f, 0.0001f, 0.01f)) {
-            m_params.sphere_kernel_radius.store(m_ui_sphere_kernel_size);
+        if (settings.monte_carlo_sampling &&
+            ImGui::DragFloat("Sampling radius", &m_ui_sphere_kernel_size, 0.0001f, 0.0001f, 0.01f)) {
+            set(&HapticSettings::sphere_kernel_radius, m_ui_sphere_kernel_size);
             viewer()->BROADCAST(&HapticInteractor::m_ui_sphere_kernel_size);
         }
         if (ImGui::Combo("Normal interpolation", &normal_interpolation, "Post-interpolation\0Pre-interpolation\0")) {
-            m_params.pre_interpolative_normals.store(static_cast<bool>(normal_interpolation));
+            set(&HapticSettings::pre_interpolative_normals, static_cast<bool>(normal_interpolation));
         }
-        if (ImGui::Checkbox("Intersection constraint", &intersection_constraint)) {
-            m_params.intersection_constraint.store(intersection_constraint);
+        if (ImGui::Checkbox("Intersection constraint", &settings.intersection_constraint)) {
+            set(&HapticSettings::intersection_constraint, settings.intersection_constraint);
         }
 
+        if (ImGui::SliderFloat("Loop rate (Hz)", &settings.loop_rate, 250.f, 10000.f, "%.0f"))
+            set(&HapticSettings::loop_rate, settings.loop_rate);
+
+        const auto statistics = m_params.statistics.load();
+        const auto &loop = statistics.scheduler;
+        ImGui::Text("Loop period: %.1f us (target %.1f us)", loop.mean_period_us, loop.target_period_us);
+        ImGui::Text("Jitter: %.2f us, min: %.1f us, max: %.1f us", loop.jitter_us, loop.min_period_us,
+                    loop.max_period_us);
+        ImGui::Text("Overruns: %llu", static_cast<unsigned long long>(loop.overruns));
+        if (statistics.allocations_counted)
+            ImGui::Text("Allocating ticks: %llu / %llu (%llu allocations)",
+                        static_cast<unsigned long long>(statistics.ticks_with_allocations),
+                        static_cast<unsigned long long>(statistics.ticks),
+                        static_cast<unsigned long long>(statistics.allocations));
+        else
+            ImGui::TextDisabled("Allocations not counted (build with HAPTIC_ALLOCATION_CHECK)");
+
+        displayLatency(statistics);
+
         ImGui::EndMenu();
     }
 
@@ -457,29 +490,33 @@ void HapticInteractor::display() {
     if (static_cast<unsigned int>(mip_map_level) != m_mip_map_ui_level) {
         enabled_mip_maps_changed = true;
         m_mip_map_ui_level = static_cast<unsigned int>(mip_map_level);
-        m_params.mip_map_level.store(m_mip_map_ui_level);
+        set(&HapticSettings::mip_map_level, m_mip_map_ui_level);
         viewer()->BROADCAST(&HapticInteractor::m_mip_map_ui_level);
     }
 
-    auto surface_volume_mode = m_params.surface_volume_mode.load();
+    auto surface_volume_mode = m_params.settings.load().surface_volume_mode;
     if (surface_volume_mode != old_ui_surface_volume_mode) {
         // value changed from haptic controller
         m_ui_surface_volume_mode = surface_volume_mode;
         viewer()->BROADCAST(&HapticInteractor::m_ui_surface_volume_mode);
     } else if (old_ui_surface_volume_mode != m_ui_surface_volume_mode) {
-        m_params.surface_volume_mode.store(m_ui_surface_volume_mode);
+        set(&HapticSettings::surface_volume_mode, m_ui_surface_volume_mode);
         viewer()->BROADCAST(&HapticInteractor::m_ui_surface_volume_mode);
     }
 
     if (enabled_mip_maps_changed) {
-        m_ui_surface_volume_enabled_mip_maps = generate_enabled_mip_maps(m_params.surface_volume_mip_map_count.load(),
-                                                                         m_params.mip_map_level.load());
+        const auto changed_settings = m_params.settings.load();
+        m_ui_surface_volume_enabled_mip_maps = generate_enabled_mip_maps(changed_settings.surface_volume_mip_map_count,
+                                                                         changed_settings.mip_map_level);
         viewer()->BROADCAST(&HapticInteractor::m_ui_surface_volume_enabled_mip_maps);
     }
 
     const auto m = glm::dmat3{viewer()->viewTransform()};
-    m_params.view_mat.store(m);
-    m_params.view_mat_inv.store(glm::inverse(m));
+    const auto m_inv = glm::inverse(m);
+    m_params.settings.update([&m, &m_inv](HapticSettings &s) {
+        s.view_mat = m;
+        s.view_mat_inv = m_inv;
+    });
 
     m_haptic_global_pos = m_params.finger_pos.load();
     m_haptic_global_force = m_params.force.load();
@@ -497,4 +534,72 @@ void HapticInteractor::display() {
         m_on_haptic_toggle(m_haptic_enabled);
         last_haptic_enabled = m_haptic_enabled;
     }
-}
\ No newline at end of file
+}
+
+void HapticInteractor::displayLatency(const HapticLoopStatistics &statistics) {
+    if (!ImGui::CollapsingHeader("Latency"))
+        return;
+
+    const auto to_us = [](chr::nanoseconds ns) { return static_cast<double>(ns.count()) * 0.001; };
+    for (std::size_t i = 0; i < m_params.latency.size(); ++i) {
+        const auto snapshot = m_params.latency[i].snapshot();
+        ImGui::Text("%s: p50 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us (%llu samples)", HapticStageNames[i],
+                    to_us(snapshot.percentile(0.5)), to_us(snapshot.percentile(0.99)),
+                    to_us(snapshot.percentile(0.999)), to_us(snapshot.max()),
+                    static_cast<unsigned long long>(snapshot.total));
+    }
+
+    // Loop periods binned over [0, 2 * target period], longer periods are put into the last bin
+    constexpr std::size_t BIN_COUNT = 64;
+    const auto range_ns = 2000.0 * statistics.scheduler.target_period_us;
+    m_ui_loop_period_histogram.assign(BIN_COUNT, 0.f);
+    const auto period = m_params.stage_latency(HapticStage::LoopPeriod).snapshot();
+    for (std::size_t i = 0; 0.0 < range_ns && i < period.counts.size(); ++i) {
+        if (period.counts[i] == 0)
+            continue;
+        const auto mid = 0.5 * static_cast<double>(LatencyHistogram::bucket_lower(i) +
+                                                   LatencyHistogram::bucket_upper(i));
+        const auto bin = std::min(static_cast<std::size_t>(mid / range_ns * BIN_COUNT), BIN_COUNT - 1);
+        m_ui_loop_period_histogram[bin] += static_cast<float>(period.counts[i]);
+    }
+    const auto overlay = std::format("Loop period, 0 - {:.0f} us", 2.0 * statistics.scheduler.target_period_us);
+    ImGui::PlotHistogram("##LoopPeriod", m_ui_loop_period_histogram.data(),
+                         static_cast<int>(m_ui_loop_period_histogram.size()), 0, overlay.c_str(), 0.f, FLT_MAX,
+                         ImVec2{0.f, 80.f});
+
+    if (ImGui::Button("Reset latency"))
+        for (auto &histogram: m_params.latency)
+            histogram.reset();
+    ImGui::SameLine();
+    if (ImGui::Button("Export latency CSV"))
+        exportLatencyCsv();
+}
+
+void HapticInteractor::exportLatencyCsv() {
+    const auto rootPath = std::filesystem::current_path() / "haptic-latency.csv";
+    auto fileDialog = pfd::save_file("Export haptic latency as ...", rootPath.string(),
+                                     {"CSV (.csv)", "*.csv", "All files", "*"}, pfd::opt::none);
+    auto filepath = std::filesystem::path{fileDialog.result()};
+
+    // If no file path was supplied, assume saving was cancelled. Abort
+    if (filepath.empty())
+        return;
+    if (filepath.extension().empty())
+        filepath.replace_extension(".csv");
+
+    // One row per non-empty histogram bucket, durations in nanoseconds
+    std::ofstream ofs{filepath, std::ofstream::trunc | std::ofstream::out};
+    ofs << "stage,bucket_lower_ns,bucket_upper_ns,count\n";
+    for (std::size_t i = 0; i < m_params.latency.size(); ++i) {
+        const auto snapshot = m_params.latency[i].snapshot();
+        for (std::size_t b = 0; b < snapshot.counts.size(); ++b)
+            if (snapshot.counts[b] != 0)
+                ofs << std::format("{},{},{},{}\n", HapticStageNames[i], LatencyHistogram::bucket_lower(b),
+                                   LatencyHistogram::bucket_upper(b), snapshot.counts[b]);
+    }
+
+    if (!ofs)
+        std::cout << "Failed to write haptic latency to " << filepath << std::endl;
+    else
+        std::cout << "Haptic latency written to " << filepath << std::endl;
+}
@@ -2,8 +2,11 @@
 #define MOLUMES_HAPTICINTERACTOR_H
 
 #include <thread>
+#include <array>
 #include <atomic>
+#include <cstdint>
 #include <functional>
+#include <memory>
 
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
@@ -11,8 +14,12 @@
 #include <glm/mat4x4.hpp>
 
 #include "Interactor.h"
-#include "../Channel.h"
 #include "../Constants.h"
+#include "../FixedRateScheduler.h"
+#include "../LatencyHistogram.h"
+#include "../SeqLock.h"
+#include "../TextureSampler.h"
+#include "../TripleBuffer.h"
 
 namespace molumes {
 /**
@@ -21,34 +28,63 @@ namespace molumes {
  * and not a Renderer.
  * The HapticInteractor is responsible for the renderloop with the haptic force-feedback device, which it does
  * by managing a separate thread. This means all communication from the rest of the program with the haptic device has
- * to go via atomics. Most of the actual physics calculations are delegated to the Physics class.
+ * to go via atomics or SeqLocks. The haptic loop runs at a fixed rate and doesn't allocate memory after its setup.
+ * Most of the actual physics calculations are delegated to the Physics class.
  */
     class HapticInteractor : public Interactor {
     public:
-        struct HapticParams {
-            std::atomic<glm::vec3> finger_pos, force;
-            std::atomic<float> interaction_bounds{1.f}, surface_force{6.f}, surface_softness{0.031f},
-                    sphere_kernel_radius{0.008f}, friction_scale{0.23f}, surface_height_multiplier{0.35f},
-                    mip_map_scale_multiplier{1.3f};
-            std::atomic<std::optional<float>> gravity_factor{std::nullopt};
-            std::atomic<bool> enable_force{false}, monte_carlo_sampling{false}, surface_volume_mode{false},
+        /**
+         * Settings of the haptic loop. Written by the UI (and the device buttons) and read by the haptic thread as one
+         * snapshot at the start of every tick, so a tick never sees a half-applied change.
+         */
+        struct HapticSettings {
+            float interaction_bounds{1.f}, surface_force{6.f}, surface_softness{0.031f}, sphere_kernel_radius{0.008f},
+                    friction_scale{0.23f}, surface_height_multiplier{0.35f}, mip_map_scale_multiplier{1.3f},
+                    gravity_factor{2.f}, loop_rate{1000.f};
+            bool enable_force{false}, enable_gravity{false}, monte_carlo_sampling{false}, surface_volume_mode{false},
                     volume_use_height_differences{false}, pre_interpolative_normals{true},
                     intersection_constraint{false}, enable_friction{true};
-            std::atomic<unsigned int> mip_map_level{0}, input_space{0}, surface_volume_mip_map_count{
-                    HapticMipMapLevels / 3};
-            std::atomic<glm::dmat3> view_mat_inv, view_mat;
+            unsigned int mip_map_level{0}, input_space{0}, surface_volume_mip_map_count{HapticMipMapLevels / 3};
+            glm::dmat3 view_mat_inv{1.0}, view_mat{1.0};
         };
 
-        using MipMapLevel = std::pair<glm::uvec2, std::vector<glm::vec4>>;
+        // Published by the haptic thread a few times per second
+        struct HapticLoopStatistics {
+            FixedRateScheduler::Statistics scheduler; // Loop periods since the previous publish
+            // Only counted when built with HAPTIC_ALLOCATION_CHECK, totals since the loop started
+            bool allocations_counted{false};
+            std::uint64_t ticks{0}, ticks_with_allocations{0}, allocations{0};
+        };
+
+        // Stages of a haptic tick with their own latency histogram, and the period of the loop itself
+        enum class HapticStage : std::size_t {
+            FetchPosition, FetchNormalTex, SampleForce, SetForce, LoopPeriod, Count
+        };
+        static constexpr std::array<const char *, static_cast<std::size_t>(HapticStage::Count)> HapticStageNames{
+                "Fetch position", "Fetch normal tex", "Sample force", "Set force", "Loop period"
+        };
+
+        struct HapticParams {
+            SeqLock<HapticSettings> settings;
+            SeqLock<HapticLoopStatistics> statistics;
+            std::atomic<glm::vec3> finger_pos, force;
+            // Recorded by the haptic thread, in release builds as well
+            std::array<LatencyHistogram, static_cast<std::size_t>(HapticStage::Count)> latency;
+
+            LatencyHistogram &stage_latency(HapticStage stage) { return latency[static_cast<std::size_t>(stage)]; }
+        };
 
     private:
         std::jthread m_thread;
         HapticParams m_params;
         bool m_haptic_enabled{false};
 
-        static MipMapLevel generate_single_mipmap(glm::uvec2 tex_dims, std::vector<glm::vec4> tex_data);
+        // Loop period histogram binned for display
+        std::vector<float> m_ui_loop_period_histogram;
+
+        void displayLatency(const HapticLoopStatistics &statistics);
 
-        float m_ui_gravity_factor_value{2.f};
+        void exportLatencyCsv();
 
     public:
         std::function<void(bool)> m_on_haptic_toggle{};
@@ -56,7 +92,7 @@ namespace molumes {
         HapticInteractor() = default;
 
         explicit HapticInteractor(Viewer *viewer,
-                                  ReaderChannel<std::array<MipMapLevel, HapticMipMapLevels>> &&normal_tex_channel);
+                                  std::shared_ptr<TripleBuffer<SampledMipPyramid>> normal_tex_buffer);
 
         bool hapticEnabled() const { return m_haptic_enabled; }
 
@@ -64,15 +100,6 @@ namespace molumes {
 
         void display() override;
 
-        template<std::size_t N = HapticMipMapLevels>
-        static auto generateMipmaps(const glm::uvec2 &tex_dims, std::vector<glm::vec4> &&tex_data) {
-            std::array<MipMapLevel, N> levels;
-            levels.at(0) = std::make_pair(tex_dims, std::move(tex_data));
-            for (glm::uint i = 1; i < N; ++i)
-                levels.at(i) = generate_single_mipmap(levels.at(i - 1).first, levels.at(i - 1).second);
-            return levels;
-        }
-
         ~HapticInteractor() override;
 
         unsigned int m_mip_map_ui_level{0};
@@ -6,6 +6,10 @@
 #include <filesystem>
 #include <format>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <sstream>
 
 #define GLFW_INCLUDE_NONE
 
@@ -33,6 +37,22 @@ auto getCurrentTime(auto currentDate) {
 }
 
 
+namespace {
+    /// Appends the prefix and the three components of v in the same format as std::format("{:e}") and a line break
+    void appendVector(std::string &out, std::string_view prefix, const vec3 &v) {
+        // Longest float in scientific notation: "-1.234567e+38"
+        std::array<char, 16> number{};
+        out += prefix;
+        for (int i{0}; i < 3; ++i) {
+            const auto result = std::to_chars(number.data(), number.data() + number.size(), v[i],
+                                              std::chars_format::scientific, 6);
+            out += ' ';
+            out.append(number.data(), result.ptr);
+        }
+        out += '\n';
+    }
+}
+
 STLExporter::STLExporter(Viewer *viewer, CrystalRenderer *crystalRenderer) : m_renderer{crystalRenderer},
                                                                              Interactor(viewer) {
 
@@ -41,7 +61,7 @@ STLExporter::STLExporter(Viewer *viewer, CrystalRenderer *crystalRenderer) : m_r
 void STLExporter::keyEvent(int key, int scancode, int action, int mods) {
     Interactor::keyEvent(key, scancode, action, mods);
 
-    if (m_renderer == nullptr || m_renderer->getVertices().empty())
+    if (m_renderer == nullptr || m_renderer->getVertices().empty() || isExporting())
         return;
 
     if (m_ctrl && key == GLFW_KEY_S && action == GLFW_PRESS)
@@ -51,23 +71,57 @@ void STLExporter::keyEvent(int key, int scancode, int action, int mods) {
 void STLExporter::display() {
     Interactor::display();
 
+    // Report a finished export
+    if (m_exportResult.valid() && isReady(m_exportResult)) {
+        switch (m_exportResult.get()) {
+            case ExportResult::Exported:
+                std::cout << "Successfully exported model as " << m_exportFilename << std::endl;
+                break;
+            case ExportResult::Cancelled:
+                std::cout << "Cancelled export of " << m_exportFilename << std::endl;
+                break;
+            case ExportResult::Failed:
+                std::cout << "Error while exporting model: " << m_exportFilename << std::endl;
+                break;
+        }
+        m_exportProgress.reset();
+    }
+
     if (m_renderer == nullptr || m_renderer->getVertices().empty())
         return;
 
     if (ImGui::BeginMenu("File")) {
-        if (ImGui::MenuItem("Export file...", "Ctrl+S"))
+        if (ImGui::MenuItem("Export file...", "Ctrl+S", false, !isExporting()))
             exportFile();
 
+        if (isExporting() && m_exportProgress) {
+            const auto stage = m_exportProgress->stage.load();
+            const auto chunkCount = m_exportProgress->chunkCount.load();
+            const auto progress = 0 < chunkCount ? static_cast<float>(m_exportProgress->chunksDone.load()) /
+                                                   static_cast<float>(chunkCount) : 0.f;
+            const auto label = stage == ExportStage::Welding ? std::string{"Welding vertices"} :
+                               stage == ExportStage::Writing ? std::format("Writing {:.0f}%", progress * 100.f) :
+                               std::string{"Validating file"};
+            ImGui::ProgressBar(stage == ExportStage::Writing ? progress : stage == ExportStage::Validating ? 1.f : 0.f,
+                               ImVec2(-1.0f, 0.0f), label.c_str());
+
+            if (ImGui::MenuItem("Cancel export", nullptr, false, !m_exportCancellation.cancelled()))
+                m_exportCancellation.cancel();
+        }
+
         ImGui::EndMenu();
     }
 }
 
 void STLExporter::exportFile() {
-    static const char *filePatterns[] = {"*.stl", "*.stl-ascii"};
+    if (m_renderer == nullptr || isExporting())
+        return;
+
     const auto rootPath = fs::current_path() / fs::path{defaultFileName};
     auto fileDialog = pfd::save_file("Export model as ...", rootPath.string(), {
             "Binary STL (.stl, *.stl-binary)", "*.stl *.stl-binary",
             "ASCII STL (.stl-ascii)", "*.stl-ascii",
+            "Binary PLY (.ply)", "*.ply",
             "All files", "*"}, pfd::opt::none);
 
     auto filepath = fs::path{fileDialog.result()};
@@ -76,133 +130,239 @@ void STLExporter::exportFile() {
     if (filepath.empty())
         return;
 
-#ifndef NDEBUG
+    // Fix extension if no extension was supplied:
+    if (filepath.extension().empty())
+        filepath.replace_extension(".stl");
+
+    // Contrary to the binary version of the file format, the ASCII version allows you to name the model.
+    // Here it defaults to the filename for simplicity.
+    auto modelName = filepath.stem() == fs::path{defaultFileName}.stem() ? defaultModelName : filepath.stem().string();
+
+    // The job works on its own copy of the vertices, so the crystal can change while the export is running
+    m_exportCancellation = CancellationSource{};
+    m_exportProgress = std::make_shared<ExportProgress>();
+    m_exportFilename = filepath.string();
+    m_exportResult = ThreadPool::global().submit(exportModel, m_renderer->getVertices(), m_exportFilename,
+                                                 std::move(modelName), m_exportCancellation.token(),
+                                                 m_exportProgress);
+}
+
+bool STLExporter::isExporting() const {
+    return m_exportResult.valid();
+}
+
+STLExporter::ExportResult
+STLExporter::exportModel(std::vector<glm::vec4> vertices, std::string filename, std::string modelName,
+                         CancellationToken cancellation, std::shared_ptr<ExportProgress> progress) {
+    const auto filepath = fs::path{filename};
+    const auto extension = filepath.extension();
+
+    // Any failure ends up as a failed export, so display() only has to report the result
+    bool written = false;
     try {
-#endif
-        if (filepath.extension() == ".stl-ascii") {
+        if (extension == ".stl-ascii") {
             std::ofstream ofs{filepath, std::ofstream::trunc | std::ofstream::out};
-            exportAscii(std::move(ofs), filepath.stem() == fs::path{defaultFileName}.stem() ? defaultModelName
-                                                                                            : filepath.stem().string());
+            written = writeAscii(ofs, vertices, modelName, cancellation, *progress);
         } else {
-            // Fix extension if no extension was supplied:
-            if (filepath.extension().empty())
-                filepath.replace_extension(".stl");
-
             std::ofstream ofs{filepath, std::ofstream::trunc | std::ofstream::out | std::ofstream::binary};
-            exportBinary(std::move(ofs));
+            written = extension == ".ply" ? writePly(ofs, vertices, cancellation, *progress)
+                                          : writeBinary(ofs, vertices, cancellation, *progress);
         }
-#ifndef NDEBUG
     }
     catch (...) {
         std::cout << "Failed to write file to " << filepath << std::endl;
-        return;
+        std::error_code ec;
+        fs::remove(filepath, ec);
+        return ExportResult::Failed;
     }
-#endif
-
-    if (validateBinaryFile(filepath.string()))
-        std::cout << "Successfully exported model as " << filepath << std::endl;
-    else
-        std::cout << "Error while exporting model: " << filepath << std::endl;
-}
 
-void STLExporter::exportAscii(std::ofstream &&ofs, const std::string &modelName) {
-    if (m_renderer == nullptr)
-        return;
-    const auto vertices = m_renderer->getVertices();
-    if (vertices.empty())
-        return;
+    if (!written) {
+        std::error_code ec;
+        fs::remove(filepath, ec);
+        return ExportResult::Cancelled;
+    }
 
-    const auto normalVertexPairs = zipNormalsAndVertices(vertices);
+    progress->stage = ExportStage::Validating;
+    if (extension == ".stl-ascii")
+        return ExportResult::Exported;
+    const auto valid = extension == ".ply" ? validatePlyFile(filename) : validateBinaryFile(filename);
+    return valid ? ExportResult::Exported : ExportResult::Failed;
+}
 
-    // Contrary to the binary version of the file format, the ASCII version allows you to name the model.
-    // Here it defaults to the filename for simplicity.
-    ofs << "solid " << modelName << std::endl;
-
-    for (const auto&[n, v1, v2, v3]: normalVertexPairs) {
-        ofs << std::format("facet normal {:e} {:e} {:e}", n.x, n.y, n.z) << std::endl;
-        ofs << "    outer loop" << std::endl;
-        ofs << std::format("        vertex {:e} {:e} {:e}", v1.x, v1.y, v1.z) << std::endl;
-        ofs << std::format("        vertex {:e} {:e} {:e}", v2.x, v2.y, v2.z) << std::endl;
-        ofs << std::format("        vertex {:e} {:e} {:e}", v3.x, v3.y, v3.z) << std::endl;
-        ofs << "    endloop" << std::endl;
-        ofs << "endfacet" << std::endl;
+bool STLExporter::writeAscii(std::ostream &os, const std::vector<glm::vec4> &vertices, const std::string &modelName,
+                             const CancellationToken &cancellation, ExportProgress &progress) {
+    const auto[vs, indices] = getVertexIndexPairs(vertices);
+    const auto triangleCount = static_cast<std::int64_t>(indices.size() / 3);
+    const auto chunkCount = (triangleCount + exportChunkSize - 1) / exportChunkSize;
+    if (cancellation.cancelled())
+        return false;
+    progress.chunkCount = chunkCount;
+    progress.stage = ExportStage::Writing;
+
+    // Facets are rendered into one text chunk per block of triangles in parallel, and written in order afterwards
+    std::vector<std::string> chunks(static_cast<std::size_t>(chunkCount));
+#pragma omp parallel for schedule(dynamic)
+    for (std::int64_t c = 0; c < chunkCount; ++c) {
+        if (cancellation.cancelled())
+            continue;
+
+        auto &chunk = chunks[c];
+        const auto end = std::min(triangleCount, (c + 1) * exportChunkSize);
+        // A facet is around 250 characters long
+        chunk.reserve(static_cast<std::size_t>(end - c * exportChunkSize) * 256);
+
+        for (auto i = c * exportChunkSize; i < end; ++i) {
+            const auto[n, v1, v2, v3] = getTriangle(vs, indices, static_cast<std::size_t>(i));
+            appendVector(chunk, "facet normal", n);
+            chunk += "    outer loop\n";
+            appendVector(chunk, "        vertex", v1);
+            appendVector(chunk, "        vertex", v2);
+            appendVector(chunk, "        vertex", v3);
+            chunk += "    endloop\n"
+                     "endfacet\n";
+        }
+        ++progress.chunksDone;
     }
+    if (cancellation.cancelled())
+        return false;
 
-    ofs << "endsolid " << modelName;
+    os << "solid " << modelName << '\n';
+    for (const auto &chunk: chunks)
+        os.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    os << "endsolid " << modelName;
+    os.flush();
+    return true;
 }
 
-void STLExporter::exportBinary(std::ofstream &&ofs) {
-    if (m_renderer == nullptr)
-        return;
-    const auto vertices = m_renderer->getVertices();
-    if (vertices.empty())
-        return;
+bool STLExporter::writeBinary(std::ostream &os, const std::vector<glm::vec4> &vertices,
+                              const CancellationToken &cancellation, ExportProgress &progress) {
+    const auto[vs, indices] = getVertexIndexPairs(vertices);
+    const auto triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    const auto chunkCount = (static_cast<std::int64_t>(triangleCount) + exportChunkSize - 1) / exportChunkSize;
+    if (cancellation.cancelled())
+        return false;
+    progress.chunkCount = chunkCount;
+    progress.stage = ExportStage::Writing;
 
-    const auto normalVertexPairs = zipNormalsAndVertices(vertices);
+    // The whole file is assembled in memory and written at once: header, triangle count and 50 bytes per triangle
+    std::vector<char> buffer(binaryHeaderSize + 4 + static_cast<std::size_t>(triangleCount) * binaryTriangleSize);
 
     const auto date = getCurrentDate();
     // The STL header contains arbitrary data, so I set it to metadata about the file generation:
     std::string header = std::format("STL file generated by Molumes software at {:%H:%M} {:%d/%m/%y} UNITS=MM :)",
                                      getCurrentTime(date), date);
     header.resize(binaryHeaderSize, ' ');
-    ofs.write(header.data(), binaryHeaderSize);
-
-    const auto byteWrite = [&ofs]<typename T>(T data, std::streamsize size = sizeof(T)) {
-        assert(size <= sizeof(T));
-        ofs.write(reinterpret_cast<const char *>(&data), size);
-    };
-
-    const auto triangleCount = static_cast<uint32_t>(normalVertexPairs.size());
-    std::cout << "Exported triangle count: " << normalVertexPairs.size() << std::endl;
-    byteWrite(triangleCount, 4);
-
-    for (const auto&[n, v1, v2, v3]: normalVertexPairs) {
-        BinaryTriangleStruct triangle{
-                .normal={n.x, n.y, n.z},
-                .vertex1={v1.x, v1.y, v1.z},
-                .vertex2={v2.x, v2.y, v2.z},
-                .vertex3={v3.x, v3.y, v3.z}
-        };
-
-        // Struct becomes 52 bytes because of machine alignment, therefore we only write the first 50
-        byteWrite(triangle, 50);
+    std::memcpy(buffer.data(), header.data(), binaryHeaderSize);
+    std::memcpy(buffer.data() + binaryHeaderSize, &triangleCount, 4);
+
+    std::cout << "Exported triangle count: " << triangleCount << std::endl;
+
+    // Every triangle has a fixed offset in the file, so the records are written in parallel chunks
+    auto *const triangles = buffer.data() + binaryHeaderSize + 4;
+#pragma omp parallel for schedule(dynamic)
+    for (std::int64_t c = 0; c < chunkCount; ++c) {
+        if (cancellation.cancelled())
+            continue;
+
+        const auto end = std::min(static_cast<std::int64_t>(triangleCount), (c + 1) * exportChunkSize);
+        for (auto i = c * exportChunkSize; i < end; ++i) {
+            const auto[n, v1, v2, v3] = getTriangle(vs, indices, static_cast<std::size_t>(i));
+            const BinaryTriangleStruct triangle{
+                    .normal={n.x, n.y, n.z},
+                    .vertex1={v1.x, v1.y, v1.z},
+                    .vertex2={v2.x, v2.y, v2.z},
+                    .vertex3={v3.x, v3.y, v3.z}
+            };
+
+            // Struct becomes 52 bytes because of machine alignment, therefore we only copy the first 50
+            std::memcpy(triangles + i * binaryTriangleSize, &triangle, binaryTriangleSize);
+        }
+        ++progress.chunksDone;
     }
-}
-
-std::vector<glm::vec3> STLExporter::normalizeRange(const std::vector<glm::vec4> &vertices, float size) {
-    std::vector<glm::vec3> out;
-    out.reserve(vertices.size());
-    for (const auto &v: vertices)
-        // Vertices from crystalrenderer are in normalized range [-1,1], same as bounding box renderer, so scaling them in the editor will scale the file output.
-        out.push_back((glm::vec3{v} * 0.5f + 0.5f) * size);
+    if (cancellation.cancelled())
+        return false;
 
-    return out;
+    os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return true;
 }
 
-std::vector<glm::vec3>
-STLExporter::calculateNormals(const std::vector<glm::vec3> &vertices, const std::vector<unsigned int> &indices) {
-    std::vector<glm::vec3> normals;
-    normals.reserve(indices.size() / 3);
-    for (std::size_t i{0}; i + 2 < indices.size(); i += 3) {
-        const auto a = vertices.at(indices.at(i + 2)) - vertices.at(indices.at(i + 1));
-        const auto b = vertices.at(indices.at(i)) - vertices.at(indices.at(i + 1));
-        const auto normal = glm::normalize(glm::cross(a, b));
-        normals.emplace_back(glm::any(glm::isnan(normal)) ? glm::vec3{0.f} : normal);
+bool STLExporter::writePly(std::ostream &os, const std::vector<glm::vec4> &vertices,
+                           const CancellationToken &cancellation, ExportProgress &progress) {
+    // Contrary to STL, PLY stores the welded vertices once and references them by index from the faces
+    const auto[vs, indices] = getVertexIndexPairs(vertices);
+    const auto vertexCount = static_cast<std::int64_t>(vs.size());
+    const auto faceCount = static_cast<std::int64_t>(indices.size() / 3);
+    const auto vertexChunkCount = (vertexCount + exportChunkSize - 1) / exportChunkSize;
+    const auto faceChunkCount = (faceCount + exportChunkSize - 1) / exportChunkSize;
+    if (cancellation.cancelled())
+        return false;
+    progress.chunkCount = vertexChunkCount + faceChunkCount;
+    progress.stage = ExportStage::Writing;
+
+    const auto header = std::format("ply\n"
+                                    "format binary_little_endian 1.0\n"
+                                    "comment Generated by Molumes software, UNITS=MM\n"
+                                    "element vertex {}\n"
+                                    "property float x\n"
+                                    "property float y\n"
+                                    "property float z\n"
+                                    "element face {}\n"
+                                    "property list uchar uint vertex_indices\n"
+                                    "end_header\n", vertexCount, faceCount);
+
+    std::vector<char> buffer(header.size() + static_cast<std::size_t>(vertexCount) * plyVertexSize +
+                             static_cast<std::size_t>(faceCount) * plyFaceSize);
+    std::memcpy(buffer.data(), header.data(), header.size());
+
+    std::cout << "Exported vertex count: " << vertexCount << ", face count: " << faceCount << std::endl;
+
+    // Vertices and faces have fixed sizes, so both are written in parallel chunks
+    auto *const vertexData = buffer.data() + header.size();
+    auto *const faceData = vertexData + vertexCount * plyVertexSize;
+#pragma omp parallel for schedule(dynamic)
+    for (std::int64_t c = 0; c < vertexChunkCount + faceChunkCount; ++c) {
+        if (cancellation.cancelled())
+            continue;
+
+        if (c < vertexChunkCount) {
+            const auto end = std::min(vertexCount, (c + 1) * exportChunkSize);
+            for (auto i = c * exportChunkSize; i < end; ++i) {
+                const auto v = normalizePosition(vs[i]);
+                const std::array<glm::float32_t, 3> position{v.x, v.y, v.z};
+                std::memcpy(vertexData + i * plyVertexSize, position.data(), plyVertexSize);
+            }
+        } else {
+            const auto faceChunk = c - vertexChunkCount;
+            const auto end = std::min(faceCount, (faceChunk + 1) * exportChunkSize);
+            for (auto i = faceChunk * exportChunkSize; i < end; ++i) {
+                auto *const face = faceData + i * plyFaceSize;
+                face[0] = 3;
+                std::memcpy(face + 1, indices.data() + i * 3, 3 * sizeof(uint32_t));
+            }
+        }
+        ++progress.chunksDone;
     }
+    if (cancellation.cancelled())
+        return false;
 
-    return normals;
+    os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return true;
 }
 
-std::vector<STLExporter::Triangle> STLExporter::zipNormalsAndVertices(const std::vector<glm::vec4> &vertices) {
-    const auto[vs, indices] = getVertexIndexPairs(vertices);
-    const auto normalized = normalizeRange(vs);
-    const auto normals = calculateNormals(normalized, indices);
-    std::vector<Triangle> planes;
-    planes.reserve(normals.size());
-    for (std::size_t i{0}; i < normals.size(); ++i)
-        planes.emplace_back(normals.at(i), normalized.at(indices.at(i * 3)), normalized.at(indices.at(i * 3 + 1)),
-                            normalized.at(indices.at(i * 3 + 2)));
-    return planes;
+glm::vec3 STLExporter::normalizePosition(const glm::vec4 &v, float size) {
+    // Vertices from crystalrenderer are in normalized range [-1,1], same as bounding box renderer, so scaling them in the editor will scale the file output.
+    return (glm::vec3{v} * 0.5f + 0.5f) * size;
+}
+
+STLExporter::Triangle
+STLExporter::getTriangle(const std::vector<glm::vec4> &vertices, const std::vector<unsigned int> &indices,
+                         std::size_t triangle) {
+    const auto v1 = normalizePosition(vertices[indices[triangle * 3]]);
+    const auto v2 = normalizePosition(vertices[indices[triangle * 3 + 1]]);
+    const auto v3 = normalizePosition(vertices[indices[triangle * 3 + 2]]);
+
+    const auto normal = glm::normalize(glm::cross(v3 - v2, v1 - v2));
+    return {glm::any(glm::isnan(normal)) ? glm::vec3{0.f} : normal, v1, v2, v3};
 }
 
 bool STLExporter::validateBinaryFile(const std::string &filename) {
@@ -219,6 +379,31 @@ bool STLExporter::validateBinaryFile(const std::string &filename) {
     ifs.read(reinterpret_cast<char *>(&triangleCount), 4);
     ifs.seekg(0, std::ios::end);
     // filesize == 80 + 4 + triangleCount * 50;
-    return ifs.tellg() == binaryHeaderSize + 4 + triangleCount * 50;
+    return ifs.tellg() == binaryHeaderSize + 4 + static_cast<std::streamoff>(triangleCount) * binaryTriangleSize;
 }
 
+bool STLExporter::validatePlyFile(const std::string &filename) {
+    const auto path = fs::path{filename};
+    if (path.empty())
+        return false;
+
+    std::ifstream ifs{path, std::ifstream::in | std::ifstream::binary};
+    if (!ifs)
+        return false;
+
+    // Element counts are read from the header, which ends at the "end_header" line
+    std::uintmax_t vertexCount{0}, faceCount{0};
+    for (std::string line; std::getline(ifs, line) && line != "end_header";) {
+        std::istringstream words{line};
+        std::string keyword, element;
+        words >> keyword >> element;
+        if (keyword == "element")
+            words >> (element == "vertex" ? vertexCount : faceCount);
+    }
+    if (!ifs)
+        return false;
+
+    const auto headerSize = static_cast<std::uintmax_t>(ifs.tellg());
+    // filesize == header + vertexCount * 12 + faceCount * 13;
+    return fs::file_size(path) == headerSize + vertexCount * plyVertexSize + faceCount * plyFaceSize;
+}
@@ -7,19 +7,28 @@
 #include <iosfwd>
 #include <vector>
 #include <array>
+#include <cstdint>
+#include <atomic>
+#include <memory>
 
 #include <glm/fwd.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 
+#include "../ThreadPool.h"
+
 namespace molumes {
 class CrystalRenderer;
 
 /**
  * @brief Custom STL Exporter utility class
  * Made with file specs from Wikipedia https://en.wikipedia.org/wiki/STL_(file_format)
+ * Also exports indexed binary PLY files (http://paulbourke.net/dataformats/ply/)
  */
 class STLExporter : public Interactor{
+    // Times writeAscii against the previous writer
+    friend class Benchmarks;
+
 private:
     /**
      * Intermediate triangle representation
@@ -43,9 +52,37 @@ private:
     };
 
     static constexpr auto binaryHeaderSize = 80u;
+    // Size of a triangle record in a binary file (normal, 3 vertices and the attribute byte count)
+    static constexpr auto binaryTriangleSize = 50u;
+    // Sizes of a vertex (3 floats) and a triangle face (uchar count and 3 uint indices) in a binary PLY file
+    static constexpr auto plyVertexSize = 12u;
+    static constexpr auto plyFaceSize = 13u;
+    // Number of triangles (or vertices) handled together by one parallel chunk of an export
+    static constexpr std::int64_t exportChunkSize = 1 << 14;
     // Arbitrary scale number with no standard. 100 worked fine in PrusaSlicer 2.3.3
     static constexpr auto boundingSize = 100.f;
 
+    enum class ExportStage {
+        Welding,
+        Writing,
+        Validating
+    };
+
+    enum class ExportResult {
+        Exported,
+        Cancelled,
+        Failed
+    };
+
+    /**
+     * Progress of an export running in the background, written by the export job and read by the GUI
+     */
+    struct ExportProgress {
+        std::atomic<ExportStage> stage{ExportStage::Welding};
+        std::atomic<std::int64_t> chunksDone{0};
+        std::atomic<std::int64_t> chunkCount{0};
+    };
+
 public:
     static constexpr auto defaultFileName = "model.stl";
     static constexpr auto defaultModelName = "crystal";
@@ -55,21 +92,45 @@ public:
     void keyEvent(int key, int scancode, int action, int mods) override;
     void display() override;
 
+    /// Asks for a file path and starts exporting a snapshot of the current crystal in the background
     void exportFile();
+    bool isExporting() const;
 
 private:
     CrystalRenderer* m_renderer{nullptr};
 
-    void exportAscii(std::ofstream&& ofs, const std::string& modelName = defaultModelName);
-    void exportBinary(std::ofstream&& ofs);
-
-    static std::vector<glm::vec3> normalizeRange(const std::vector<glm::vec4>& vertices, float size = boundingSize);
-    static std::vector<glm::vec3> calculateNormals(const std::vector<glm::vec3>& vertices, const std::vector<unsigned int>& indices);
-    /// Calculates normals and pairs them together with triangles as normal-triangle pairs.
-    static std::vector<Triangle> zipNormalsAndVertices(const std::vector<glm::vec4>& vertices);
+    /**
+     * Export job run on the thread pool: welds the vertices, writes the file in the format given by its
+     * extension and validates it. Stops early (and removes the unfinished file) once it's cancelled.
+     */
+    static ExportResult exportModel(std::vector<glm::vec4> vertices, std::string filename, std::string modelName,
+                                    CancellationToken cancellation, std::shared_ptr<ExportProgress> progress);
+
+    // The writers below return false if they were cancelled before they were done
+    /// Renders the facets of the welded mesh with std::to_chars in parallel chunks and writes them in order
+    static bool writeAscii(std::ostream& os, const std::vector<glm::vec4>& vertices, const std::string& modelName,
+                           const CancellationToken& cancellation, ExportProgress& progress);
+    /// Writes a binary STL file assembled in one buffer
+    static bool writeBinary(std::ostream& os, const std::vector<glm::vec4>& vertices,
+                            const CancellationToken& cancellation, ExportProgress& progress);
+    /// Writes the welded mesh as an indexed binary PLY file
+    static bool writePly(std::ostream& os, const std::vector<glm::vec4>& vertices,
+                         const CancellationToken& cancellation, ExportProgress& progress);
+
+    static glm::vec3 normalizePosition(const glm::vec4& v, float size = boundingSize);
+    /// Normalizes the positions of a triangle of an indexed mesh and calculates its normal.
+    static Triangle getTriangle(const std::vector<glm::vec4>& vertices, const std::vector<unsigned int>& indices, std::size_t triangle);
 
     /// Checks that the written size of the file is the same as what's specified in the header of the file
     static bool validateBinaryFile(const std::string& filename);
+    /// Checks that the size of a binary PLY file matches the element counts in its header
+    static bool validatePlyFile(const std::string& filename);
+
+    std::future<ExportResult> m_exportResult;
+    // Cancels a running export, also when the exporter is destroyed
+    CancellationSource m_exportCancellation;
+    std::shared_ptr<ExportProgress> m_exportProgress;
+    std::string m_exportFilename;
 };
 }
 
@@ -1,6 +1,9 @@
 #include <iostream>
 #include <numeric>
 #include <algorithm>
+#include <filesystem>
+#include <span>
+#include <string_view>
 
 #include <glbinding/Version.h>
 #include <glbinding/Binding.h>
@@ -29,8 +32,11 @@
 #include <globjects/Sync.h>
 #include <globjects/Query.h>
 
+#include "Benchmarks.h"
 #include "Scene.h"
 #include "CSV/Table.h"
+#include "CSV/CSVParser.h"
+#include "CSV/PointCloudFile.h"
 #include "Viewer.h"
 #include "interactors/Interactor.h"
 #include "renderer/Renderer.h"
@@ -45,7 +51,62 @@ void error_callback(int errnum, const char *errmsg) {
     globjects::critical() << errnum << ": " << errmsg << std::endl;
 }
 
+/**
+ * @brief Converter mode: writes a binary point cloud (.mpc) next to every given CSV file, or next to every CSV file in
+ * the given directories.
+ * @return exit code of the application
+ */
+int convertToPointClouds(std::vector<std::filesystem::path> inputs) {
+    using namespace std::filesystem;
+    if (inputs.empty())
+        inputs.emplace_back("./dat");
+
+    std::vector<path> files;
+    for (const auto &input: inputs) {
+        if (is_directory(input)) {
+            for (const auto &entry: directory_iterator{input})
+                if (entry.is_regular_file() && entry.path().extension() == ".csv")
+                    files.push_back(entry.path());
+        } else {
+            files.push_back(input);
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    int result = 0;
+    for (const auto &file: files) {
+        const auto parsed = parseCSV(file.string());
+        if (!parsed) {
+            std::cout << "Failed to read " << file.string() << std::endl;
+            result = 1;
+            continue;
+        }
+
+        const std::vector<std::span<const float>> columns{parsed->columns.begin(), parsed->columns.end()};
+        auto output = file;
+        output.replace_extension(PointCloudFile::extension);
+        if (!PointCloudFile::write(output.string(), parsed->columnNames, columns)) {
+            std::cout << "Failed to write " << output.string() << std::endl;
+            result = 1;
+            continue;
+        }
+
+        std::cout << "Converted " << file.string() << " -> " << output.string() << " ("
+                  << (columns.empty() ? 0 : columns.front().size()) << " rows, " << columns.size() << " columns)"
+                  << std::endl;
+    }
+    return result;
+}
+
 int main(int argc, char *argv[]) {
+    // molumes --convert [file.csv | directory]...
+    if (argc > 1 && std::string_view{argv[1]} == "--convert")
+        return convertToPointClouds({argv + 2, argv + argc});
+
+    // molumes --benchmark [name]...
+    if (argc > 1 && std::string_view{argv[1]} == "--benchmark")
+        return Benchmarks::run({argv + 2, argv + argc});
+
     // Initialize GLFW
     if (!glfwInit())
         return 1;
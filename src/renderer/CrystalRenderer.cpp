@@ -23,17 +23,10 @@ using namespace globjects;
 using namespace glm;
 using namespace gl;
 
-constexpr std::size_t MAX_HEXAGON_SIZE = 10000u;
 constexpr auto MAX_SYNC_TIME = static_cast<GLuint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
         std::chrono::milliseconds{100}).count());
 constexpr std::array<const char *, 2> RENDERSTYLES{"depth", "phong"};
 
-/// Waits for as little as it can and checks if the future is ready.
-template<typename T>
-bool isReady(const std::future<T> &f) {
-    return f.wait_for(std::chrono::nanoseconds{0}) == std::future_status::ready;
-}
-
 CrystalRenderer::CrystalRenderer(Viewer *viewer) : Renderer(viewer) {
     resizeVertexBuffer(MAX_HEXAGON_SIZE);
 
@@ -181,8 +174,9 @@ void CrystalRenderer::display() {
     /**
      * The basic geometry pipeline goes like this:
      * 1. Invoke a compute shader that calculates the main geometry
-     * 2. Pass the result of the last step back to the CPU and use it to find a convex hull on a background thread
-     * 3. Invoke a few new compute shaders to cull the main geometry using the convex hull and add some additional
+     * 2. Pass the result of the last step back to the CPU and use it to find a convex or concave hull on a
+     * background thread
+     * 3. Invoke a few new compute shaders to cull the main geometry using the hull and add some additional
      * extra geometry
      * 4. Pass the result of the last step back to the CPU for some final data cleanup
      */
@@ -195,24 +189,23 @@ void CrystalRenderer::display() {
                                           tile->m_tileMaxY, count, num_cols, num_rows,
                                           scale, normalizationTransformation);
         m_modelMatrix = getModelMatrix(); // While we're creating the new model, set the model matrix to the scaling / translating one
-        std::get<0>(m_workerResults) = {};
-        std::get<1>(m_workerResults) = {};
+        m_convexHullResult = {};
+        m_concaveHullResult = {};
+        m_postProcessingResult = {};
     }
 
     // 2. Hull calculation:
-    // Transfer data from GPU to background worker thread, and start worker thread
+    // Transfer data from GPU and start the hull job on the thread pool
     if (syncObject) {
         const auto syncResult = syncObject->clientWait(GL_SYNC_FLUSH_COMMANDS_BIT, MAX_SYNC_TIME);
         if (syncResult != GL_WAIT_FAILED && syncResult != GL_TIMEOUT_EXPIRED) {
-            const auto vCount = getVertexCountMainGeometry(count);
-            const auto memPtr = reinterpret_cast<vec4 *>(m_computeBuffer->mapRange(0, vCount *
-                                                                                      static_cast<GLsizeiptr>(sizeof(vec4)),
-                                                                                   GL_MAP_READ_BIT));
+            const auto centerCount = getHexCenterCount(count);
+            const auto memPtr = reinterpret_cast<vec4 *>(m_hexCenterBuffer->mapRange(0, centerCount *
+                                                                                        static_cast<GLsizeiptr>(sizeof(vec4)),
+                                                                                     GL_MAP_READ_BIT));
             if (memPtr != nullptr) {
-                // Temporarily save all vertices:
-                m_vertices = std::vector<vec4>{memPtr + 0, memPtr + vCount};
-                const std::vector<vec4> halfVertices{
-                        m_vertices.begin(), m_vertices.begin() + m_vertices.size() / 2};
+                // The hull only needs the center of every hexagon (concave geometry only the upper half of them)
+                m_hexCenters = std::vector<vec4>{memPtr + 0, memPtr + (getGeometryMode() == Concave ? count : centerCount)};
                 float upper{-1.f + m_valueThreshold * 2.f}, lower{-1.f};
                 switch (m_geometryMode) {
                     case Concave:
@@ -225,16 +218,16 @@ void CrystalRenderer::display() {
                         lower = 2.0f * m_cutValue - m_cutWidth - 1.f;
                         break;
                 }
-                std::get<0>(m_workerResults) = std::move(m_worker.queue_job<0>(getHexagonConvexHull,
-                                                                               getGeometryMode() == Concave ? halfVertices : m_vertices,
-                                                                               std::move(std::weak_ptr{
-                                                                                       m_workerControlFlag}), upper,
-                                                                               lower));
+                if (m_concaveHullEnabled)
+                    m_concaveHullResult = m_concaveHullJob.submit(getHexagonConcaveHull, m_hexCenters,
+                                                                  m_workerCancellation.token(), upper, lower, count,
+                                                                  num_cols, scale, m_concaveHullRadius);
+                else
+                    m_convexHullResult = m_convexHullJob.submit(getHexagonConvexHull, m_hexCenters,
+                                                                m_workerCancellation.token(), upper, lower);
             }
-            if (!m_computeBuffer->unmap())
-                throw std::runtime_error{"Failed to unmap GPU buffer! (compute vertex buffer)"};
-
-            m_vertices.resize(m_vertices.size() * 3, vec4{0.f}); // Make room for extrusions + extra geometry
+            if (!m_hexCenterBuffer->unmap())
+                throw std::runtime_error{"Failed to unmap GPU buffer! (hexagon center buffer)"};
 
             /**
              * Using a sync object here forces a sync between the GPU and the CPU, making the GPU have to wait for the
@@ -249,8 +242,14 @@ void CrystalRenderer::display() {
              * https://on-demand.gputechconf.com/gtc/2012/presentations/S0356-GTC2012-Texture-Transfers.pdf
              * https://www.seas.upenn.edu/~pcozzi/OpenGLInsights/OpenGLInsights-AsynchronousBufferTransfers.pdf
              */
-            // Option 2: Orphaning buffer and uploading data while waiting for async multithreaded operation to finish:
-            m_computeBuffer2->setData(m_vertices, GL_STREAM_DRAW);
+            // Option 2: Orphaning buffer and copying the geometry over on the GPU while waiting for async multithreaded
+            // operation to finish. Only the hexagon centers above ever leave the GPU.
+            const auto mainGeometrySize = static_cast<GLsizeiptr>(getVertexCountMainGeometry(count) * sizeof(vec4));
+            m_computeBuffer2->setData(getBufferSize(count), nullptr, GL_STREAM_DRAW);
+            m_computeBuffer->copySubData(m_computeBuffer2.get(), 0, 0, mainGeometrySize);
+            // Make room for extrusions + extra geometry
+            m_computeBuffer2->clearSubData(GL_RGBA32F, mainGeometrySize, getBufferSize(count) - mainGeometrySize,
+                                           GL_RGBA, GL_FLOAT, nullptr);
         } else {
             std::cout << "Error: Sync Object was "
                       << (syncResult == GL_WAIT_FAILED ? "GL_WAIT_FAILED" : "GL_TIMEOUT_EXPIRED") << std::endl;
@@ -260,19 +259,37 @@ void CrystalRenderer::display() {
     }
 
     // 3. If worker is done, run a new compute-shader call to remove outside hexes and extrude edges
-    if (std::get<0>(m_workerResults).valid() && isReady(std::get<0>(m_workerResults))) {
-        auto result = std::get<0>(m_workerResults).get();
+    if (m_convexHullResult.valid() && isReady(m_convexHullResult)) {
+        auto result = m_convexHullResult.get();
         if (result) {
             m_vertexHull = *result;
 
             std::vector<glm::vec4> hullVertices;
             hullVertices.reserve(m_vertexHull.size());
             for (auto i: m_vertexHull)
-                hullVertices.push_back(m_vertices.at(i));
+                hullVertices.push_back(m_hexCenters.at(i));
             m_hullBuffer = Buffer::create();
             m_hullBuffer->setStorage(static_cast<GLsizeiptr>(hullVertices.size() * sizeof(vec4)), hullVertices.data(),
                                      GL_NONE_BIT);
             m_hullSize = static_cast<int>(hullVertices.size());
+            m_hullIsConcave = false;
+
+            m_hexagonsSecondPartUpdated = true;
+        }
+    }
+
+    if (m_concaveHullResult.valid() && isReady(m_concaveHullResult)) {
+        auto result = m_concaveHullResult.get();
+        if (result) {
+            m_hullMaskBuffer = Buffer::create();
+            m_hullMaskBuffer->setStorage(static_cast<GLsizeiptr>(result->inside.size() * sizeof(uint)),
+                                         result->inside.data(), GL_NONE_BIT);
+            // The boundary is only used for rendering the hull (a hull with non-empty hexagons always has one)
+            m_hullBuffer = Buffer::create();
+            m_hullBuffer->setStorage(static_cast<GLsizeiptr>(result->boundary.size() * sizeof(vec4)),
+                                     result->boundary.data(), GL_NONE_BIT);
+            m_hullSize = static_cast<int>(result->boundary.size());
+            m_hullIsConcave = true;
 
             m_hexagonsSecondPartUpdated = true;
         }
@@ -284,7 +301,7 @@ void CrystalRenderer::display() {
                                     m_tileNormalsEnabled ? resources.tileNormalsBuffer : std::weak_ptr<Buffer>{},
                                     tile->m_tileMaxY, count, num_cols, num_rows, scale, normalizationTransformation);
 
-        std::get<1>(m_workerResults) = {};
+        m_postProcessingResult = {};
     }
 
     // 4. Wait for edge extruding until final geometry cleanup:
@@ -296,10 +313,9 @@ void CrystalRenderer::display() {
                                                                                        static_cast<GLsizeiptr>(sizeof(vec4)),
                                                                                     GL_MAP_READ_BIT));
             if (memPtr != nullptr)
-                std::get<1>(m_workerResults) = std::move(
-                        m_worker.queue_job<1>(geometryPostProcessing,
-                                              std::vector<vec4>{memPtr + 0, memPtr + vCount},
-                                              std::move(std::weak_ptr{m_workerControlFlag})));
+                m_postProcessingResult = m_postProcessingJob.submit(geometryPostProcessing,
+                                                                    std::vector<vec4>{memPtr + 0, memPtr + vCount},
+                                                                    m_workerCancellation.token());
             if (!m_computeBuffer2->unmap())
                 throw std::runtime_error{"Failed to unmap GPU buffer!"};
         } else {
@@ -308,8 +324,8 @@ void CrystalRenderer::display() {
         }
     }
 
-    if (std::get<1>(m_workerResults).valid() && isReady(std::get<1>(m_workerResults))) {
-        auto result = std::get<1>(m_workerResults).get();
+    if (m_postProcessingResult.valid() && isReady(m_postProcessingResult)) {
+        auto result = m_postProcessingResult.get();
         if (result) {
             m_vertices = *result;
             // Create new buffer subset (unlinking m_computeBuffer)
@@ -365,7 +381,7 @@ void CrystalRenderer::display() {
             binding->setFormat(4, GL_FLOAT);
             m_vao->enable(0);
 
-            m_vao->drawArrays(GL_LINE_STRIP, 0, static_cast<int>(m_hullSize));
+            m_vao->drawArrays(m_hullIsConcave ? GL_LINES : GL_LINE_STRIP, 0, static_cast<int>(m_hullSize));
         }
     }
 
@@ -384,7 +400,7 @@ std::unique_ptr<Sync> CrystalRenderer::generateBaseGeometry(std::shared_ptr<glob
     if (!shader)
         return {};
 
-    m_workerControlFlag = std::make_shared<bool>(true);
+    m_workerCancellation = CancellationSource{};
 
     // Make sure to do at least as many invocations as there are hexagons (invocation space is in n^3)
     const auto invocationSpace = std::max(static_cast<GLuint>(std::ceil(std::pow(
@@ -397,6 +413,7 @@ std::unique_ptr<Sync> CrystalRenderer::generateBaseGeometry(std::shared_ptr<glob
     m_maxValDiff->clearData(GL_R32UI, GL_RED, GL_UNSIGNED_INT, nullptr);
 
     m_computeBuffer->bindBase(GL_SHADER_STORAGE_BUFFER, 0);
+    m_hexCenterBuffer->bindBase(GL_SHADER_STORAGE_BUFFER, 5);
     accumulateTexture->bindActive(1);
     accumulateMax->bindBase(GL_SHADER_STORAGE_BUFFER, 2);
     if (tileNormalsEnabled) {
@@ -428,6 +445,7 @@ std::unique_ptr<Sync> CrystalRenderer::generateBaseGeometry(std::shared_ptr<glob
         tileNormalsBuffer->unbind(GL_SHADER_STORAGE_BUFFER, 3);
     accumulateMax->unbind(GL_SHADER_STORAGE_BUFFER, 2);
     accumulateTexture->unbindActive(1);
+    m_hexCenterBuffer->unbind(GL_SHADER_STORAGE_BUFFER, 5);
     m_computeBuffer->unbind(GL_SHADER_STORAGE_BUFFER, 0);
 
     // Share resource with m_vertexBuffer, orphaning the old buffer (CPU orphaning)
@@ -438,7 +456,7 @@ std::unique_ptr<Sync> CrystalRenderer::generateBaseGeometry(std::shared_ptr<glob
     // We are going to use the buffer for drawing, but also copy it onwards in the next step of the process
     glMemoryBarrier(
             GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT |
-            GL_ATOMIC_COUNTER_BARRIER_BIT);
+            GL_ATOMIC_COUNTER_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
     auto syncObject = std::move(Sync::fence(GL_SYNC_GPU_COMMANDS_COMPLETE));
     m_hexagonsUpdated = false;
 
@@ -464,6 +482,8 @@ CrystalRenderer::cullAndExtrude(std::shared_ptr<globjects::Texture> &&accumulate
 
         m_computeBuffer2->bindBase(GL_SHADER_STORAGE_BUFFER, 0);
         m_hullBuffer->bindBase(GL_SHADER_STORAGE_BUFFER, 1);
+        if (m_hullIsConcave)
+            m_hullMaskBuffer->bindBase(GL_SHADER_STORAGE_BUFFER, 5);
         accumulateTexture->bindActive(2);
         if (tileNormalsEnabled) {
             tileNormalsBuffer = tileNormalsRef.lock();
@@ -477,7 +497,8 @@ CrystalRenderer::cullAndExtrude(std::shared_ptr<globjects::Texture> &&accumulate
         shader->setUniform("tile_scale", tile_scale);
         shader->setUniform("disp_mat", disp_mat);
         shader->setUniform("POINT_COUNT", static_cast<GLuint>(count));
-        shader->setUniform("HULL_SIZE", static_cast<GLuint>(m_hullSize));
+        shader->setUniform("HULL_SIZE", static_cast<GLuint>(m_hullIsConcave ? 0 : m_hullSize));
+        shader->setUniform("concaveHull", m_hullIsConcave);
         shader->setUniform("extrude_factor", m_extrusionFactor);
         shader->setUniform("maxTexCoordY", tile_max_y);
         shader->setUniform("tileNormalsEnabled", tileNormalsEnabled);
@@ -491,6 +512,8 @@ CrystalRenderer::cullAndExtrude(std::shared_ptr<globjects::Texture> &&accumulate
         if (tileNormalsEnabled)
             tileNormalsBuffer->unbind(GL_SHADER_STORAGE_BUFFER, 3);
         accumulateTexture->unbindActive(2);
+        if (m_hullIsConcave)
+            m_hullMaskBuffer->unbind(GL_SHADER_STORAGE_BUFFER, 5);
         m_hullBuffer->unbind(GL_SHADER_STORAGE_BUFFER, 1);
         m_computeBuffer2->unbind(GL_SHADER_STORAGE_BUFFER, 0);
     }
@@ -582,11 +605,15 @@ void CrystalRenderer::resizeVertexBuffer(int hexCount) {
 
     m_computeBuffer = Buffer::create();
     /// Note: glBufferStorage only changes characteristics of how data is stored, so data itself is just as fast when doing glBufferData
-    m_computeBuffer->setStorage(bufferSize, nullptr,
-                                BufferStorageMask::GL_MAP_PERSISTENT_BIT | BufferStorageMask::GL_MAP_READ_BIT);
+    // The geometry is only copied on the GPU, so it never needs to be mapped
+    m_computeBuffer->setStorage(bufferSize, nullptr, BufferStorageMask::GL_NONE_BIT);
     assert(m_computeBuffer->getParameter(GL_BUFFER_SIZE) == bufferSize); // Check that requested size == actual size
 
     m_computeBuffer->bind(GL_SHADER_STORAGE_BUFFER);
+
+    m_hexCenterBuffer = Buffer::create();
+    m_hexCenterBuffer->setStorage(static_cast<gl::GLsizeiptr>(getHexCenterCount(hexCount) * sizeof(glm::vec4)), nullptr,
+                                  BufferStorageMask::GL_MAP_PERSISTENT_BIT | BufferStorageMask::GL_MAP_READ_BIT);
 }
 
 #ifndef NDEBUG
@@ -637,6 +664,10 @@ void CrystalRenderer::drawGUI(bool &bufferNeedsResize) {
                 m_hexagonsUpdated = true;
         } else if (ImGui::SliderFloat("Hull value threshold", &m_valueThreshold, 0.f, 1.f))
             m_hexagonsUpdated = true;
+        if (ImGui::Checkbox("Concave hull", &m_concaveHullEnabled))
+            m_hexagonsUpdated = true;
+        if (m_concaveHullEnabled && ImGui::SliderInt("Concave hull closing radius", &m_concaveHullRadius, 0, 10))
+            m_hexagonsUpdated = true;
         // Doesn't work unless you actually generate the normal plane from the 2D view:
         if (ImGui::Checkbox("Align with regression plane", &m_tileNormalsEnabled))
             m_hexagonsUpdated = true;
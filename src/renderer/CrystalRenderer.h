@@ -8,7 +8,7 @@
 #include <glm/mat4x4.hpp>
 
 #include "Renderer.h"
-#include "../WorkerThread.h"
+#include "../ThreadPool.h"
 #include "../GeometryUtils.h"
 
 namespace globjects {
@@ -35,9 +35,11 @@ namespace molumes {
         bool m_renderHull = true;
         bool m_tileNormalsEnabled = true;
         bool m_orientationNotchEnabled = false;
+        bool m_concaveHullEnabled = false;
         int m_renderStyleOption = 1;
         int m_topRegressionPlaneAlignment{2}, m_bottomRegressionPlaneAlignment{2};
         int m_geometryMode = 3;
+        int m_concaveHullRadius = 2;
         float m_tileScale = 1.0f;
         float m_tileHeight = 0.5f;
         float m_tileNormalsFactor = 30.f;
@@ -50,13 +52,16 @@ namespace molumes {
         float m_orientationNotchAngle = 45.f;
 
     public:
+        /// Number of hexagons the geometry buffers are allocated for
+        static constexpr std::size_t MAX_HEXAGON_SIZE = 10000u;
+
         explicit CrystalRenderer(Viewer *viewer);
 
         void setEnabled(bool enabled) override;
 
         void display() override;
 
-        auto getVertices() const { return m_vertices; }
+        const auto &getVertices() const { return m_vertices; }
 
         void fileLoaded(const std::string &) override;
 
@@ -97,21 +102,31 @@ namespace molumes {
         // m_vertexBuffer is either m_computeBuffer or a smaller separate buffer subset
         // Using shared_ptr to check if shared resource is same
         std::shared_ptr<globjects::Buffer> m_computeBuffer, m_computeBuffer2, m_vertexBuffer;
+        // Center of every hexagon, the only part of the geometry that is read back for the hull calculation
+        std::unique_ptr<globjects::Buffer> m_hexCenterBuffer;
         std::unique_ptr<globjects::Buffer> m_hullBuffer;
+        std::unique_ptr<globjects::Buffer> m_hullMaskBuffer;
         std::unique_ptr<globjects::Buffer> m_maxValDiff;
 
-        using WorkerThreadT = decltype(worker_manager_from_functions(getHexagonConvexHull, geometryPostProcessing));
-        WorkerThreadT::ResultTypes m_workerResults;
-        WorkerThreadT m_worker{};
-        // Seems weird to have a pointer to a bool, but I'm only using this as a signal to the worker thread because
-        // weak_ptr::expired() is thread-safe.
-        std::shared_ptr<bool> m_workerControlFlag;
+        // Background jobs run on the thread pool. Only the newest submission of each is run, so stale geometry
+        // doesn't pile up while a slider is dragged
+        CoalescingJob<std::optional<std::vector<glm::uint>>> m_convexHullJob;
+        CoalescingJob<std::optional<HexagonHullMask>> m_concaveHullJob;
+        CoalescingJob<std::optional<std::vector<glm::vec4>>> m_postProcessingJob;
+        std::future<std::optional<std::vector<glm::uint>>> m_convexHullResult;
+        std::future<std::optional<HexagonHullMask>> m_concaveHullResult;
+        std::future<std::optional<std::vector<glm::vec4>>> m_postProcessingResult;
+        // Replaced for every new geometry, which cancels the jobs still working on the previous one
+        CancellationSource m_workerCancellation;
 
         std::vector<glm::vec4> m_vertices;
+        std::vector<glm::vec4> m_hexCenters;
         std::vector<unsigned int> m_vertexHull;
         glm::mat4 m_modelMatrix{1.f};
         gl::GLsizei m_drawingCount = 0;
         gl::GLsizei m_hullSize = 0;
+        // Whether the current hull is a concave hull mask (with m_hullBuffer holding its boundary as lines)
+        bool m_hullIsConcave = false;
         bool m_hexagonsUpdated = true;
         bool m_hexagonsSecondPartUpdated = false;
 
@@ -140,6 +155,11 @@ namespace molumes {
 
         auto getGeometryMode() const { return static_cast<GeometryMode>(m_geometryMode); }
 
+        /// Returns the number of hexagon centers (count multiplied by 2 if geometry type != normal)
+        auto getHexCenterCount(int count) const {
+            return count * (getGeometryMode() != Normal ? 2 : 1);
+        }
+
         /// Returns the vertex count to be drawn to screen
         static auto getDrawingCount(int count) {
             return count * 6 * 2 * 3;
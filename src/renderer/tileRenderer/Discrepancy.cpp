@@ -0,0 +1,207 @@
+#include "Discrepancy.h"
+
+#include <omp.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+using namespace molumes;
+
+namespace {
+    // samples handled by one block while bucketing the samples by tile
+    constexpr std::size_t minSamplesPerBlock = 1 << 15;
+    // tiles with at most this many points are compared pairwise, which is faster than sorting for small tiles
+    constexpr std::size_t pairwiseTileSize = 64;
+
+    struct NormalizedPoint {
+        float x;
+        float y;
+    };
+
+    // per thread buffers that are reused for every tile
+    struct TileScratch {
+        std::vector<NormalizedPoint> points;
+        std::vector<float> uniqueY;
+        std::vector<unsigned int> fenwick;
+    };
+
+    // maps value x from [a,b] --> [0,1], same as TileRenderer::mapInterval(x, a, b, 1)
+    float normalize(float x, float a, float b) {
+        return (x - a) / (b - a);
+    }
+
+    std::size_t lowestBit(std::size_t i) {
+        return i & (~i + 1);
+    }
+
+    float maxDifferencePairwise(const std::vector<NormalizedPoint> &points) {
+        const auto count = static_cast<float>(points.size());
+        float maxDifference = 0.0f;
+
+        for (const auto &stop: points) {
+            // closed interval [0, stop]
+            unsigned int countInside = 0;
+            for (const auto &sample: points)
+                countInside += (sample.x <= stop.x && sample.y <= stop.y) ? 1 : 0;
+
+            const float difference = std::abs(static_cast<float>(countInside) / count - stop.x * stop.y);
+            maxDifference = std::max(maxDifference, difference);
+        }
+        return maxDifference;
+    }
+
+    float maxDifferenceSweep(TileScratch &scratch) {
+        auto &points = scratch.points;
+        const auto count = static_cast<float>(points.size());
+
+        std::sort(points.begin(), points.end(), [](const NormalizedPoint &a, const NormalizedPoint &b) {
+            return a.x < b.x || (a.x == b.x && a.y < b.y);
+        });
+
+        // rank of every y value, equal values share a rank
+        auto &uniqueY = scratch.uniqueY;
+        uniqueY.resize(points.size());
+        std::transform(points.begin(), points.end(), uniqueY.begin(), [](const NormalizedPoint &p) { return p.y; });
+        std::sort(uniqueY.begin(), uniqueY.end());
+        uniqueY.erase(std::unique(uniqueY.begin(), uniqueY.end()), uniqueY.end());
+
+        auto &fenwick = scratch.fenwick;
+        fenwick.assign(uniqueY.size() + 1, 0);
+
+        const auto rankOf = [&uniqueY](float y) {
+            return static_cast<std::size_t>(std::lower_bound(uniqueY.begin(), uniqueY.end(), y) - uniqueY.begin()) + 1;
+        };
+
+        float maxDifference = 0.0f;
+        for (std::size_t groupBegin = 0; groupBegin < points.size();) {
+            // points with the same x dominate each other in x, so the whole group is inserted before querying
+            std::size_t groupEnd = groupBegin;
+            while (groupEnd < points.size() && points[groupEnd].x == points[groupBegin].x) {
+                for (auto i = rankOf(points[groupEnd].y); i < fenwick.size(); i += lowestBit(i))
+                    fenwick[i]++;
+                groupEnd++;
+            }
+
+            for (std::size_t j = groupBegin; j < groupEnd; j++) {
+                unsigned int countInside = 0;
+                for (auto i = rankOf(points[j].y); i > 0; i -= lowestBit(i))
+                    countInside += fenwick[i];
+
+                const float difference = std::abs(static_cast<float>(countInside) / count - points[j].x * points[j].y);
+                maxDifference = std::max(maxDifference, difference);
+            }
+            groupBegin = groupEnd;
+        }
+        return maxDifference;
+    }
+
+    float tileMaxDifference(std::span<const float> x, std::span<const float> y, TileScratch &scratch) {
+        if (x.empty())
+            return 0.0f;
+
+        const auto [minX, maxX] = std::minmax_element(x.begin(), x.end());
+        const auto [minY, maxY] = std::minmax_element(y.begin(), y.end());
+
+        // normalizing a degenerate extent yields NaN for every point, so no difference is ever larger than 0
+        if (*minX == *maxX || *minY == *maxY)
+            return 0.0f;
+
+        auto &points = scratch.points;
+        points.resize(x.size());
+        for (std::size_t i = 0; i < x.size(); i++)
+            points[i] = {normalize(x[i], *minX, *maxX), normalize(y[i], *minY, *maxY)};
+
+        if (points.size() <= pairwiseTileSize)
+            return maxDifferencePairwise(points);
+        return maxDifferenceSweep(scratch);
+    }
+}
+
+TileDiscrepancies molumes::calculateTileDiscrepancies(std::span<const float> samplesX, std::span<const float> samplesY,
+                                                      std::span<const int> tileIndices, int numTiles) {
+    const std::size_t numSamples = tileIndices.size();
+    const auto tileCount = static_cast<std::size_t>(std::max(numTiles, 0));
+
+    TileDiscrepancies result;
+    result.maxDifferences.assign(tileCount, 0.0f);
+    result.pointCounts.assign(tileCount, 0);
+    if (tileCount == 0)
+        return result;
+
+    // the samples are split into one contiguous block per thread, every block is bucketed on its own
+    const int blockCount = static_cast<int>(std::clamp<std::size_t>(numSamples / minSamplesPerBlock, 1,
+                                                                    static_cast<std::size_t>(omp_get_max_threads())));
+    const std::size_t blockSize = (numSamples + blockCount - 1) / blockCount;
+    std::vector<std::size_t> blockOffsets(static_cast<std::size_t>(blockCount) * tileCount, 0);
+
+    //Step 1: count how many samples of each block belong to each tile
+#pragma omp parallel for schedule(static)
+    for (int b = 0; b < blockCount; b++) {
+        auto *counts = blockOffsets.data() + b * tileCount;
+        const std::size_t end = std::min(numSamples, (b + 1) * blockSize);
+        for (std::size_t i = b * blockSize; i < end; i++) {
+            if (tileIndices[i] >= 0)
+                counts[tileIndices[i]]++;
+        }
+    }
+
+    //Step 2: prefix sum over the tiles and, within every tile, over the blocks
+#pragma omp parallel for schedule(static)
+    for (int t = 0; t < static_cast<int>(tileCount); t++) {
+        std::size_t count = 0;
+        for (int b = 0; b < blockCount; b++)
+            count += blockOffsets[b * tileCount + t];
+        result.pointCounts[t] = static_cast<unsigned int>(count);
+    }
+
+    std::vector<std::size_t> tileOffsets(tileCount + 1, 0);
+    for (std::size_t t = 0; t < tileCount; t++) {
+        tileOffsets[t + 1] = tileOffsets[t] + result.pointCounts[t];
+        result.maxPointCount = std::max(result.maxPointCount, result.pointCounts[t]);
+    }
+
+#pragma omp parallel for schedule(static)
+    for (int t = 0; t < static_cast<int>(tileCount); t++) {
+        std::size_t offset = tileOffsets[t];
+        for (int b = 0; b < blockCount; b++) {
+            const auto count = blockOffsets[b * tileCount + t];
+            blockOffsets[b * tileCount + t] = offset;
+            offset += count;
+        }
+    }
+
+    //Step 3: sort the samples into one bucket per tile, every block writes to its own disjoint ranges
+    std::vector<float> sortedX(tileOffsets.back());
+    std::vector<float> sortedY(tileOffsets.back());
+
+#pragma omp parallel for schedule(static)
+    for (int b = 0; b < blockCount; b++) {
+        auto *offsets = blockOffsets.data() + b * tileCount;
+        const std::size_t end = std::min(numSamples, (b + 1) * blockSize);
+        for (std::size_t i = b * blockSize; i < end; i++) {
+            if (tileIndices[i] < 0)
+                continue;
+            const auto sampleIndex = offsets[tileIndices[i]]++;
+            sortedX[sampleIndex] = samplesX[i];
+            sortedY[sampleIndex] = samplesY[i];
+        }
+    }
+
+    //Step 4: calculate the discrepancy of each tile
+    // the point counts of the tiles are very uneven, so the tiles are scheduled dynamically
+#pragma omp parallel
+    {
+        TileScratch scratch;
+
+#pragma omp for schedule(dynamic, 8)
+        for (int t = 0; t < static_cast<int>(tileCount); t++) {
+            const auto begin = tileOffsets[t];
+            const auto count = tileOffsets[t + 1] - begin;
+            result.maxDifferences[t] = tileMaxDifference(std::span<const float>(sortedX).subspan(begin, count),
+                                                         std::span<const float>(sortedY).subspan(begin, count),
+                                                         scratch);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+namespace molumes {
+
+    // per tile result of the discrepancy sweep, before the ease in / low count transfer function is applied
+    struct TileDiscrepancies {
+        // largest difference between the share of points inside [0,p] and the area of [0,p], for every point p of
+        // the tile normalized to the bounding box of the tile's points
+        std::vector<float> maxDifferences;
+        // number of points inside each tile
+        std::vector<unsigned int> pointCounts;
+        unsigned int maxPointCount = 0;
+    };
+
+    // Calculates the discrepancy of the points inside every tile.
+    // tileIndices holds the 1D tile index of every sample (see Tile::mapPointToTile1D), all spans have the same size.
+    // Samples with a negative tile index are outside of the grid and ignored.
+    // The samples are bucketed by tile in parallel, afterwards every tile is normalized once and the dominance counts
+    // are taken from a sweep over the points sorted by x with a Fenwick tree over the y ranks, O(k log k) per tile.
+    TileDiscrepancies calculateTileDiscrepancies(std::span<const float> samplesX, std::span<const float> samplesY,
+                                                 std::span<const int> tileIndices, int numTiles);
+}
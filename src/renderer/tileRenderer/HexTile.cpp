@@ -178,76 +178,26 @@ void HexTile::calculateNumberOfTiles(vec3 boundingBoxSize, vec3 minBounds)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
-bool molumes::HexTile::pointLeftOfLine(vec2 a, vec2 b, vec2 p) {
-	return ((p.x - a.x)*(b.y - a.y) - (p.y - a.y)*(b.x - a.x)) < 0;
+int molumes::HexTile::mapPointToTile1D(vec2 p)
+{
+	return mapPointToTile(mapping(), p.x, p.y);
 }
 
-int molumes::HexTile::mapPointToTile1D(vec2 p)
+void molumes::HexTile::mapPointsToTiles1D(std::span<const float> x, std::span<const float> y, std::span<int> tileIndices)
 {
-	// to get intervals from 0 to maxCoord, we map the original Point interval to maxCoord+1
-	// If the current value = maxValue, we take the maxCoord instead
-	int rectX = min(max_rect_col, mapInterval(p.x, minBounds_Offset.x, maxBounds_rect.x, max_rect_col + 1));
-	int rectY = min(max_rect_row, mapInterval(p.y, minBounds_Offset.y, maxBounds_rect.y, max_rect_row + 1));
-
-	// rectangle left lower corner in space of points
-	vec2 ll = vec2(rectX * rect_width + minBounds_Offset.x, rectY *rect_height + minBounds_Offset.y);
-	vec2 a, b;
-
-	// calculate hexagon index from rectangle index
-	int hexX, hexY, modX, modY;
-
-	// get modulo values
-	modX = rectX % 3;
-	modY = rectY % 2;
-
-	//calculate X index
-	hexX = int(rectX / 3) * 2 + modX - 1;
-	if (modX != 2) {
-		if (modX == 0) {
-			if (modY == 0) {
-				//Upper Left
-				a = vec2(ll.x + rect_width / 2.0f, ll.y + rect_height);
-				b = ll;
-				if (pointLeftOfLine(a, b, p)) {
-					hexX++;
-				}
-			}
-			//modY = 1
-			else {
-				//Lower Left
-				a = vec2(ll.x, ll.y + rect_height);
-				b = vec2(ll.x + rect_width / 2.0f, ll.y);
-				if (pointLeftOfLine(a, b, p)) {
-					hexX++;
-				}
-			}
-		}
-		//modX = 1
-		else {
-
-			if (modY == 0) {
-				//Upper Right
-				a = vec2(ll.x + rect_width / 2.0f, ll.y + rect_height);
-				b = vec2(ll.x + rect_width, ll.y);
-				if (pointLeftOfLine(a, b, p)) {
-					hexX++;
-				}
-			}
-			//modY = 1
-			else {
-				//Lower Right
-				a = vec2(ll.x + rect_width, ll.y + rect_height);
-				b = vec2(ll.x + rect_width / 2.0f, ll.y);
-				if (pointLeftOfLine(a, b, p)) {
-					hexX++;
-				}
-			}
-		}
-	}
+	mapPointsToTiles(mapping(), x, y, tileIndices);
+}
+
+HexTileMapping molumes::HexTile::mapping() const
+{
+	return { minBounds_Offset, maxBounds_rect, rect_width, rect_height, max_rect_col, max_rect_row, m_tile_cols, m_tile_rows };
+}
 
-	// Y Coordinate
-	hexY = int((rectY - (1 - (hexX % 2))) / 2);
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//ACCUMULATION
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	// calculate 1D coordinates
-	return hexX + m_tile_cols * hexY;
-}
\ No newline at end of file
+TileAccumulation molumes::HexTile::accumulatePoints(std::span<const float> x, std::span<const float> y)
+{
+	return accumulateTiles(mapping(), x, y);
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "Tile.h"
+#include "TileMapping.h"
 #include <memory>
 
 #include <glm/glm.hpp>
@@ -29,12 +30,15 @@ namespace molumes
 		// maps a datapoint to its tile
 		// returns 1D tile coordinates, assuming the tiles are saved in an 1D array one row after the other
 		int mapPointToTile1D(glm::vec2 p) override;
+		void mapPointsToTiles1D(std::span<const float> x, std::span<const float> y, std::span<int> tileIndices) override;
 
-	private:
+		// ACCUMULATION -------------------------------------------------------------------
+		TileAccumulation accumulatePoints(std::span<const float> x, std::span<const float> y) override;
 
-		// DISCREPANCY -------------------------------------------------------------------
-		// check if a points is left of the given line
-		bool pointLeftOfLine(glm::vec2 a, glm::vec2 b, glm::vec2 p);
+		// parameters of the current grid for mapping points without virtual calls
+		HexTileMapping mapping() const;
+
+	private:
 
 		// TILE CALC VARIABLES -------------------------------------------------------------------
 		// horizontal space of hexagon tile = 1.5 * tileSize
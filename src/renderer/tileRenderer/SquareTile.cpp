@@ -122,12 +122,21 @@ void SquareTile::calculateNumberOfTiles(vec3 boundingBoxSize, vec3 minBounds)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 int SquareTile::mapPointToTile1D(vec2 p) {
+	return mapPointToTile(mapping(), p.x, p.y);
+}
+
+void SquareTile::mapPointsToTiles1D(std::span<const float> x, std::span<const float> y, std::span<int> tileIndices) {
+	mapPointsToTiles(mapping(), x, y, tileIndices);
+}
+
+SquareTileMapping SquareTile::mapping() const {
+	return { minBounds_Offset, maxBounds_Offset, m_tileMaxX, m_tileMaxY, m_tile_cols, m_tile_rows };
+}
 
-	// to get intervals from 0 to maxTexCoord, we map the original Point interval to maxTexCoord+1
-	// If the current value = maxValue, we take the maxTexCoord instead
-	int squareX = min(m_tileMaxX, mapInterval(p.x, minBounds_Offset[0], maxBounds_Offset[0], m_tileMaxX + 1));
-	int squareY = min(m_tileMaxY, mapInterval(p.y, minBounds_Offset[1], maxBounds_Offset[1], m_tileMaxY + 1));
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//ACCUMULATION
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	// compute 1D coordinates
-	return squareX + m_tile_cols * squareY;
-}
\ No newline at end of file
+TileAccumulation SquareTile::accumulatePoints(std::span<const float> x, std::span<const float> y) {
+	return accumulateTiles(mapping(), x, y);
+}
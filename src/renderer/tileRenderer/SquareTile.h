@@ -1,5 +1,6 @@
 #pragma once
 #include "Tile.h"
+#include "TileMapping.h"
 #include <memory>
 
 #include <glm/glm.hpp>
@@ -29,6 +30,13 @@ namespace molumes
 		// maps a datapoint to its tile
 		// returns 1D tile coordinates, assuming the tiles are saved in an 1D array one row after the other
 		int mapPointToTile1D(glm::vec2 p) override;
+		void mapPointsToTiles1D(std::span<const float> x, std::span<const float> y, std::span<int> tileIndices) override;
+
+		// ACCUMULATION -------------------------------------------------------------------
+		TileAccumulation accumulatePoints(std::span<const float> x, std::span<const float> y) override;
+
+		// parameters of the current grid for mapping points without virtual calls
+		SquareTileMapping mapping() const;
 
 	private:
 
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "../Renderer.h"
+#include "TileAccumulation.h"
 #include <memory>
+#include <span>
 
 #include <glm/glm.hpp>
 
@@ -36,8 +38,17 @@ namespace molumes {
         // DISCREPANCY -------------------------------------------------------------------
         // maps a datapoint to its tile
         // returns 1D tile coordinates, assuming the tiles are saved in an 1D array one row after the other
+        // returns -1 for points outside of the tile grid
         virtual int mapPointToTile1D(glm::vec2 p) = 0;
 
+        // maps all points (x[i], y[i]) to their tiles at once, same result as mapPointToTile1D for every point
+        // all spans need to have the same size
+        virtual void mapPointsToTiles1D(std::span<const float> x, std::span<const float> y, std::span<int> tileIndices) = 0;
+
+        // ACCUMULATION -------------------------------------------------------------------
+        // counts the points inside each tile on the CPU, same result as the accumulation program
+        virtual TileAccumulation accumulatePoints(std::span<const float> x, std::span<const float> y) = 0;
+
         // TILE CALC VARIABLES -------------------------------------------------------------------
         // divisor of tile size that is set by the user when calculation tileSizeWS
         const float tileSizeDiv = 500.0f;
@@ -0,0 +1,82 @@
+#include "TileAccumulation.h"
+
+#include <omp.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+using namespace molumes;
+
+namespace {
+    // points mapped at once by one thread before they are counted
+    constexpr std::size_t pointsPerBlock = 4096;
+
+    template<typename Mapping>
+    TileAccumulation accumulate(const Mapping &mapping, std::span<const float> x, std::span<const float> y) {
+        const auto tileCount = static_cast<std::size_t>(std::max(mapping.cols, 0)) * static_cast<std::size_t>(std::max(mapping.rows, 0));
+        const auto blockCount = static_cast<std::int64_t>((x.size() + pointsPerBlock - 1) / pointsPerBlock);
+
+        // one histogram per thread, so counting needs no atomics
+        std::vector<std::vector<std::uint32_t>> histograms(omp_get_max_threads());
+
+#pragma omp parallel
+        {
+            auto &histogram = histograms[omp_get_thread_num()];
+            histogram.assign(tileCount, 0);
+            std::array<int, pointsPerBlock> tileIndices;
+
+#pragma omp for schedule(static)
+            for (std::int64_t b = 0; b < blockCount; b++) {
+                const auto first = static_cast<std::size_t>(b) * pointsPerBlock;
+                const auto count = std::min(pointsPerBlock, x.size() - first);
+                const std::span<int> blockIndices(tileIndices.data(), count);
+
+                mapPointsToTiles(mapping, x.subspan(first, count), y.subspan(first, count), blockIndices);
+
+                // points outside of the grid are clipped in the render pass
+                for (const int tile: blockIndices) {
+                    if (tile >= 0)
+                        histogram[tile]++;
+                }
+            }
+        }
+
+        // merge the histograms, the accumulate texture stores the counts as floats
+        TileAccumulation result;
+        result.counts.resize(tileCount);
+        // every thread keeps its own maximum, they are combined after the loop (max reductions are OpenMP 3.1,
+        // MSVC only supports OpenMP 2.0)
+        std::vector<float> threadMaxCounts(histograms.size(), 0.0f);
+
+#pragma omp parallel
+        {
+            float threadMaxCount = 0.0f;
+
+#pragma omp for schedule(static)
+            for (std::int64_t t = 0; t < static_cast<std::int64_t>(tileCount); t++) {
+                std::uint32_t count = 0;
+                for (const auto &histogram: histograms) {
+                    if (!histogram.empty())
+                        count += histogram[t];
+                }
+                result.counts[t] = static_cast<float>(count);
+                threadMaxCount = std::max(threadMaxCount, result.counts[t]);
+            }
+
+            threadMaxCounts[omp_get_thread_num()] = threadMaxCount;
+        }
+
+        result.maxCount = *std::max_element(threadMaxCounts.begin(), threadMaxCounts.end());
+        return result;
+    }
+}
+
+TileAccumulation molumes::accumulateTiles(const SquareTileMapping &mapping, std::span<const float> x,
+                                          std::span<const float> y) {
+    return accumulate(mapping, x, y);
+}
+
+TileAccumulation molumes::accumulateTiles(const HexTileMapping &mapping, std::span<const float> x,
+                                          std::span<const float> y) {
+    return accumulate(mapping, x, y);
+}
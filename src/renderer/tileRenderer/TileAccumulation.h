@@ -0,0 +1,25 @@
+#pragma once
+
+#include "TileMapping.h"
+
+#include <span>
+#include <vector>
+
+namespace molumes {
+
+    // number of points inside every tile, same layout as the red channel of the accumulate texture
+    struct TileAccumulation {
+        // cols * rows values, one row after the other
+        std::vector<float> counts;
+        float maxCount = 0.0f;
+    };
+
+    // CPU version of the accumulation render pass (square-acc-vs.glsl / hexagon-acc-vs.glsl with additive blending).
+    // Runs without a GL context, so it can be used headless and as a reference for the GPU result.
+    // The points are mapped in blocks and counted into one histogram per thread, which are summed up at the end.
+    TileAccumulation accumulateTiles(const SquareTileMapping &mapping, std::span<const float> x,
+                                     std::span<const float> y);
+
+    TileAccumulation accumulateTiles(const HexTileMapping &mapping, std::span<const float> x,
+                                     std::span<const float> y);
+}
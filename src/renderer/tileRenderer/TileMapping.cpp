@@ -0,0 +1,105 @@
+#include "TileMapping.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace molumes;
+
+// omp declare simd and omp simd are OpenMP 4.0. MSVC's /openmp is OpenMP 2.0 and warns about them (an error with
+// /WX), so they are only used where the compiler supports them. The loops are still simple enough to auto-vectorize.
+#if defined(_OPENMP) && _OPENMP >= 201307
+#define MOLUMES_OPENMP_SIMD
+#endif
+
+namespace {
+    // The per point functions only take scalars and have vector variants (omp declare simd) that the batch loops below
+    // call for several points at once. The mapping is chosen once per call instead of once per point.
+
+    // 1D coordinates of a tile, -1 outside of the grid (such points are clipped by the accumulation pass)
+    int tileIndex(int tileX, int tileY, int cols, int rows) {
+        const bool insideGrid = tileX >= 0 && tileX < cols && tileY >= 0 && tileY < rows;
+        return insideGrid ? tileX + cols * tileY : -1;
+    }
+
+    //maps value x from [a,b] --> [0,c]
+    int mapInterval(float x, float a, float b, int c) {
+        return int((x - a) * static_cast<float>(c) / (b - a));
+    }
+
+#ifdef MOLUMES_OPENMP_SIMD
+#pragma omp declare simd uniform(mapping) notinbranch
+#endif
+    int squareTileIndex(const SquareTileMapping &mapping, float x, float y) {
+        // to get intervals from 0 to maxTexCoord, we map the original Point interval to maxTexCoord+1
+        // If the current value = maxValue, we take the maxTexCoord instead
+        const int squareX = std::min(mapping.maxX, mapInterval(x, mapping.minBounds.x, mapping.maxBounds.x, mapping.maxX + 1));
+        const int squareY = std::min(mapping.maxY, mapInterval(y, mapping.minBounds.y, mapping.maxBounds.y, mapping.maxY + 1));
+
+        return tileIndex(squareX, squareY, mapping.cols, mapping.rows);
+    }
+
+    // same computation as matchPointWithHexagon in res/tiles/hexagon/globals.glsl
+#ifdef MOLUMES_OPENMP_SIMD
+#pragma omp declare simd uniform(mapping) notinbranch
+#endif
+    int hexTileIndex(const HexTileMapping &mapping, float x, float y) {
+        // to get intervals from 0 to maxCoord, we map the original Point interval to maxCoord+1
+        // If the current value = maxValue, we take the maxCoord instead
+        const int rectX = std::min(mapping.maxRectCol, mapInterval(x, mapping.minBounds.x, mapping.maxBoundsRect.x, mapping.maxRectCol + 1));
+        const int rectY = std::min(mapping.maxRectRow, mapInterval(y, mapping.minBounds.y, mapping.maxBoundsRect.y, mapping.maxRectRow + 1));
+
+        // rectangle left lower corner in space of points
+        const float llX = static_cast<float>(rectX) * mapping.rectWidth + mapping.minBounds.x;
+        const float llY = static_cast<float>(rectY) * mapping.rectHeight + mapping.minBounds.y;
+
+        // GLSL mod, the result is never negative
+        const int modX = (rectX % 3 + 3) % 3;
+        const int modY = (rectY % 2 + 2) % 2;
+
+        // line a->b through the rectangle that separates the two hexagons it overlaps
+        // modX == 0: upper left (modY == 0) or lower left, modX == 1: upper right (modY == 0) or lower right
+        // the offsets are blended with exact 0/1 factors, conditional floating point math would stop the vectorization
+        const float halfWidth = mapping.rectWidth / 2.0f;
+        const float upperRow = static_cast<float>(1 - modY);
+        const float rightColumn = static_cast<float>(modX & 1);
+        const float aX = llX + ((1.0f - upperRow) * halfWidth + upperRow * rightColumn * mapping.rectWidth);
+        const float bX = llX + (upperRow * halfWidth + (1.0f - upperRow) * rightColumn * mapping.rectWidth);
+        const float aY = llY;
+        const float bY = llY + mapping.rectHeight;
+        const bool leftOfLine = ((x - aX) * (bY - aY) - (y - aY) * (bX - aX)) > 0;
+
+        // if modX != 2 we need to check if we are in correct hexagon
+        const int hexX = (rectX / 3) * 2 + modX - 1 + (int(modX != 2) & int(leftOfLine));
+        const int hexY = (rectY - (1 - (hexX % 2 + 2) % 2)) / 2;
+
+        return tileIndex(hexX, hexY, mapping.cols, mapping.rows);
+    }
+}
+
+void molumes::mapPointsToTiles(const SquareTileMapping &mapping, std::span<const float> x, std::span<const float> y,
+                               std::span<int> tileIndices) {
+    const auto count = static_cast<std::int64_t>(tileIndices.size());
+#ifdef MOLUMES_OPENMP_SIMD
+#pragma omp simd
+#endif
+    for (std::int64_t i = 0; i < count; i++)
+        tileIndices[i] = squareTileIndex(mapping, x[i], y[i]);
+}
+
+void molumes::mapPointsToTiles(const HexTileMapping &mapping, std::span<const float> x, std::span<const float> y,
+                               std::span<int> tileIndices) {
+    const auto count = static_cast<std::int64_t>(tileIndices.size());
+#ifdef MOLUMES_OPENMP_SIMD
+#pragma omp simd
+#endif
+    for (std::int64_t i = 0; i < count; i++)
+        tileIndices[i] = hexTileIndex(mapping, x[i], y[i]);
+}
+
+int molumes::mapPointToTile(const SquareTileMapping &mapping, float x, float y) {
+    return squareTileIndex(mapping, x, y);
+}
+
+int molumes::mapPointToTile(const HexTileMapping &mapping, float x, float y) {
+    return hexTileIndex(mapping, x, y);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <span>
+
+#include <glm/glm.hpp>
+
+namespace molumes {
+
+    // Parameters for mapping points to the tiles of a grid without any renderer state (or GL context), so whole
+    // columns can be mapped with a single call.
+
+    // square tile grid, see SquareTile::calculateNumberOfTiles and res/tiles/square/square-acc-vs.glsl
+    struct SquareTileMapping {
+        glm::vec2 minBounds = glm::vec2(0.0f);
+        glm::vec2 maxBounds = glm::vec2(0.0f);
+        int maxX = 0;
+        int maxY = 0;
+        int cols = 0;
+        int rows = 0;
+    };
+
+    // hexagon tile grid, see HexTile::calculateNumberOfTiles and matchPointWithHexagon in res/tiles/hexagon/globals.glsl
+    struct HexTileMapping {
+        // bounds of the rectangle grid used to find the hexagons
+        glm::vec2 minBounds = glm::vec2(0.0f);
+        glm::vec2 maxBoundsRect = glm::vec2(0.0f);
+        float rectWidth = 0.0f;
+        float rectHeight = 0.0f;
+        int maxRectCol = 0;
+        int maxRectRow = 0;
+        int cols = 0;
+        int rows = 0;
+    };
+
+    // maps every point (x[i], y[i]) to its 1D tile index, tiles are saved one row after the other
+    // points outside of the cols x rows tiles of the grid are mapped to -1, all spans need to have the same size
+    void mapPointsToTiles(const SquareTileMapping &mapping, std::span<const float> x, std::span<const float> y,
+                          std::span<int> tileIndices);
+
+    void mapPointsToTiles(const HexTileMapping &mapping, std::span<const float> x, std::span<const float> y,
+                          std::span<int> tileIndices);
+
+    // 1D tile index of a single point
+    int mapPointToTile(const SquareTileMapping &mapping, float x, float y);
+    int mapPointToTile(const HexTileMapping &mapping, float x, float y);
+}
@@ -1,17 +1,21 @@
 #include "TileRenderer.h"
 #include "../../Utils.h"
 #include "../../DelegateUtils.h"
+#include "../../ThreadPool.h"
 #include "../../interactors/CameraInteractor.h"
 
 #include <imgui.h>
 #include <omp.h>
 #include <lodepng.h>
 #include <ctime>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <format>
 #include <algorithm>
 #include <chrono>
 #include <filesystem>
+#include <iostream>
 
 #include <glbinding/gl/gl.h>
 
@@ -42,6 +46,7 @@
 #include "Tile.h"
 #include "SquareTile.h"
 #include "HexTile.h"
+#include "Discrepancy.h"
 #include "../../Viewer.h"
 #include "../../Scene.h"
 #include "../../CSV/Table.h"
@@ -57,9 +62,8 @@ auto get_index_offset(uint current_index, int offset) {
     return index < 0 ? TileRenderer::ROUND_ROBIN_SIZE + index : index;
 }
 
-TileRenderer::TileRenderer(Viewer *viewer,
-                           WriterChannel<std::array<std::pair<glm::uvec2, std::vector<glm::vec4>>, HapticMipMapLevels>> &&normal_channel)
-        : Renderer(viewer), m_normal_tex_channel{normal_channel} {
+TileRenderer::TileRenderer(Viewer *viewer, std::shared_ptr<TripleBuffer<SampledMipPyramid>> normal_tex_buffer)
+        : Renderer(viewer), m_normal_tex_buffer{std::move(normal_tex_buffer)} {
     m_verticesQuad->setStorage(std::array<vec3, 1>({vec3(0.0f, 0.0f, 0.0f)}), gl::GL_NONE_BIT);
     auto vertexBindingQuad = m_vaoQuad->binding(0);
     vertexBindingQuad->setBuffer(m_verticesQuad.get(), 0, sizeof(vec3));
@@ -289,14 +293,16 @@ void TileRenderer::display() {
     setShaderDefines();
     // ---------------------------------------------------------------------------------------------------------------------------
 
+    appendStreamedRows();
+
     // do not render if either the dataset was not loaded or the window is minimized
-    if (viewer()->scene()->table()->activeTableData().empty() || viewer()->viewportSize().x == 0 ||
+    if (viewer()->scene()->table()->activeRowCount() == 0 || viewer()->viewportSize().x == 0 ||
         viewer()->viewportSize().y == 0) {
         return;
     }
 
     // number of datapoints
-    int vertexCount = int(viewer()->scene()->table()->activeTableData()[0].size());
+    int vertexCount = int(viewer()->scene()->table()->activeRowCount());
 
     // retrieve/compute all necessary matrices and related properties
     const mat4 viewMatrix = viewer()->viewTransform();
@@ -323,17 +329,15 @@ void TileRenderer::display() {
     // recompute the resolution and positioning of the current tile grid
     // reset the texture resolutions
     // recompute the discrepancy
+    // (ease in and low count only change the transfer function in the discrepancy shader and need none of this)
     if (m_selected_tile_style != m_selected_tile_style_tmp || m_tileSize != m_tileSize_tmp ||
-        m_renderDiscrepancy != m_renderDiscrepancy_tmp
-        || m_discrepancy_easeIn != m_discrepancy_easeIn_tmp || m_discrepancy_lowCount != m_discrepancy_lowCount_tmp ||
+        m_renderDiscrepancy != m_renderDiscrepancy_tmp ||
         viewer()->viewportSize() != m_framebufferSize) {
 
         // set new values
         m_selected_tile_style = m_selected_tile_style_tmp;
         m_tileSize = m_tileSize_tmp;
         m_renderDiscrepancy = m_renderDiscrepancy_tmp;
-        m_discrepancy_easeIn = m_discrepancy_easeIn_tmp;
-        m_discrepancy_lowCount = m_discrepancy_lowCount_tmp;
 
         //set tile processor
         switch (m_selected_tile_style) {
@@ -493,6 +497,9 @@ void TileRenderer::discrepanciesRenderPass() {
     shaderProgram_discrepancies->setUniform("numCols", tile->m_tile_cols);
     shaderProgram_discrepancies->setUniform("numRows", tile->m_tile_rows);
     shaderProgram_discrepancies->setUniform("discrepancyDiv", m_discrepancyDiv);
+    shaderProgram_discrepancies->setUniform("discrepancyEaseIn", m_discrepancy_easeIn);
+    shaderProgram_discrepancies->setUniform("discrepancyLowCount", m_discrepancy_lowCount);
+    shaderProgram_discrepancies->setUniform("maxPointCount", static_cast<float>(m_maxTilePointCount));
 
     m_vaoTiles->bind();
     shaderProgram_discrepancies->use();
@@ -570,14 +577,21 @@ void TileRenderer::kdeRenderPass(int vertexCount, const mat4 &modelViewProjectio
 
 void TileRenderer::accumulateRenderPass(int vertexCount) {
     // Accumulate Points into tiles
+    // The accumulation only depends on the tile grid and the data, so only points that were added since the last
+    // pass have to be drawn. calculateTileTextureSize() and updateData() reset the count to start over.
+    if (vertexCount <= m_accumulatedVertexCount)
+        return;
+
     BindGuard _g1{m_tileAccumulateFramebuffer};
 
     // set viewport to size of accumulation texture
     glViewport(0, 0, tile->m_tile_cols, tile->m_tile_rows);
 
-    glClearDepth(1.0f);
-    glClearColor(0.0, 0.0, 0.0, 0.0);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (m_accumulatedVertexCount == 0) {
+        glClearDepth(1.0f);
+        glClearColor(0.0, 0.0, 0.0, 0.0);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
 
     // make sure points are drawn on top of each other
     glEnable(GL_DEPTH_TEST);
@@ -596,7 +610,8 @@ void TileRenderer::accumulateRenderPass(int vertexCount) {
     m_vao->bind();
     shaderProgram_tile_acc->use();
 
-    m_vao->drawArrays(GL_POINTS, 0, vertexCount);
+    m_vao->drawArrays(GL_POINTS, m_accumulatedVertexCount, vertexCount - m_accumulatedVertexCount);
+    m_accumulatedVertexCount = vertexCount;
 
     Program::release();
     m_vao->unbind();
@@ -608,6 +623,11 @@ void TileRenderer::accumulateRenderPass(int vertexCount) {
     glViewport(0, 0, viewer()->viewportSize().x, viewer()->viewportSize().y);
 
     glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+#ifdef TILE_ACCUMULATION_CHECK
+    if (m_accumulatedVertexCount == static_cast<int>(viewer()->scene()->table()->activeRowCount()))
+        verifyTileAccumulation();
+#endif
 }
 
 void TileRenderer::maxValRenderPass(const mat4 &modelViewProjectionMatrix, const vec2 &maxBounds,
@@ -961,6 +981,8 @@ void TileRenderer::shadeRenderPass() {
 // ###########################  TILES ############################################
 // --------------------------------------------------------------------------------------
 void TileRenderer::calculateTileTextureSize(const mat4 &inverseModelViewProjectionMatrix) {
+    // tile grid changes, so every point has to be accumulated again
+    m_accumulatedVertexCount = 0;
 
     // if we only render points, we do not need to calculate tile sizes
     if (tile != nullptr) {
@@ -992,23 +1014,30 @@ void TileRenderer::calculateTileTextureSize(const mat4 &inverseModelViewProjecti
         vertexBinding->setFormat(1, GL_FLOAT);
         m_vaoTiles->enable(0);
 
-        //calc2D discrepancy and setup discrepancy buffer
-        std::vector<float> tilesDiscrepancies(tile->numTiles, 0.0f);
-
-        if (m_renderDiscrepancy) {
-            tilesDiscrepancies = calculateDiscrepancy2D(viewer()->scene()->table()->activeXColumn(),
-                                                        viewer()->scene()->table()->activeYColumn(),
-                                                        viewer()->scene()->table()->maximumBounds(),
-                                                        viewer()->scene()->table()->minimumBounds());
+        //calc2D discrepancy and setup discrepancy buffers
+        // discrepancy of a partially streamed table is skipped, it is computed once all rows are read
+        if (m_renderDiscrepancy && !viewer()->scene()->table()->isStreaming()) {
+            const auto &tileDiscrepancies = cachedDiscrepancy2D();
+            m_discrepanciesBuffer->setData(tileDiscrepancies.maxDifferences, GL_STATIC_DRAW);
+            m_tilePointCountsBuffer->setData(tileDiscrepancies.pointCounts, GL_STATIC_DRAW);
+            m_maxTilePointCount = tileDiscrepancies.maxPointCount;
+        } else {
+            m_discrepanciesBuffer->setData(std::vector<float>(tile->numTiles, 0.0f), GL_STATIC_DRAW);
+            m_tilePointCountsBuffer->setData(std::vector<unsigned int>(tile->numTiles, 0), GL_STATIC_DRAW);
+            m_maxTilePointCount = 0;
         }
 
-        m_discrepanciesBuffer->setData(tilesDiscrepancies, GL_STATIC_DRAW);
-
         vertexBinding = m_vaoTiles->binding(1);
         vertexBinding->setAttribute(1);
         vertexBinding->setBuffer(m_discrepanciesBuffer.get(), 0, sizeof(float));
         vertexBinding->setFormat(1, GL_FLOAT);
         m_vaoTiles->enable(1);
+
+        vertexBinding = m_vaoTiles->binding(2);
+        vertexBinding->setAttribute(2);
+        vertexBinding->setBuffer(m_tilePointCountsBuffer.get(), 0, sizeof(unsigned int));
+        vertexBinding->setIFormat(1, GL_UNSIGNED_INT);
+        m_vaoTiles->enable(2);
     }
 }
 
@@ -1035,6 +1064,13 @@ void TileRenderer::renderGUI() {
             updateData();
             m_normals_parameters_changed = true;
         }
+
+        const auto *table = viewer()->scene()->table();
+        if (table->isStreaming() && table->expectedRowCount() > 0) {
+            const auto progress = static_cast<float>(table->activeRowCount()) / static_cast<float>(table->expectedRowCount());
+            const auto label = std::format("{} / {} rows", table->activeRowCount(), table->expectedRowCount());
+            ImGui::ProgressBar(progress, ImVec2(-1.0f, 0.0f), label.c_str());
+        }
     }
 
     // NB: "Fixing" this bug made it so that the 2D visualization isn't properly updated unless the menu is open
@@ -1059,8 +1095,8 @@ void TileRenderer::renderGUI() {
         ImGui::Checkbox("Render Point Circles", &m_renderPointCircles);
         ImGui::SliderFloat("Point Circle Radius", &m_pointCircleRadius, 1.0f, 100.0f);
         ImGui::Checkbox("Show Discrepancy", &m_renderDiscrepancy_tmp);
-        ImGui::SliderFloat("Ease In", &m_discrepancy_easeIn_tmp, 1.0f, 5.0f);
-        ImGui::SliderFloat("Low Point Count", &m_discrepancy_lowCount_tmp, 0.0f, 1.0f);
+        ImGui::SliderFloat("Ease In", &m_discrepancy_easeIn, 1.0f, 5.0f);
+        ImGui::SliderFloat("Low Point Count", &m_discrepancy_lowCount, 0.0f, 1.0f);
         ImGui::SliderFloat("Discrepancy Divisor", &m_discrepancyDiv, 1.0f, 3.0f);
     }
     if (ImGui::CollapsingHeader("Tiles", ImGuiTreeNodeFlags_DefaultOpen)) {
@@ -1208,170 +1244,86 @@ float molumes::TileRenderer::mapInterval(float x, float a, float b, int c) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //PRECONDITION: tile != nullptr
-std::vector<float>
-TileRenderer::calculateDiscrepancy2D(const std::vector<float> &samplesX, const std::vector<float> &samplesY,
+TileDiscrepancies
+TileRenderer::calculateDiscrepancy2D(std::span<const float> samplesX, std::span<const float> samplesY,
                                      vec3 maxBounds, vec3 minBounds) {
 
     // Calculates the discrepancy of this data.
-    // Assumes the data is [0,1) for valid sample range.
     // Assmues samplesX.size() == samplesY.size()
-    std::size_t numSamples = samplesX.size();
-
-    std::vector<float> sortedX(numSamples, 0.0f);
-    std::vector<float> sortedY(numSamples, 0.0f);
-
-    std::vector<float> pointsInTilesCount(tile->numTiles, 0.0f);
-    std::vector<float> tilesMaxBoundX(tile->numTiles, -INFINITY);
-    std::vector<float> tilesMaxBoundY(tile->numTiles, -INFINITY);
-    std::vector<float> tilesMinBoundX(tile->numTiles, INFINITY);
-    std::vector<float> tilesMinBoundY(tile->numTiles, INFINITY);
-
-    std::vector<float> discrepancies(tile->numTiles, 0.0f);
-
-    float eps = 0.05f;
+    // The ease in and low count transfer function is applied afterwards in the discrepancy shader.
+    // map every sample to its tile once, the tile index is used for counting and for sorting the samples
+    std::vector<int> tileIndices(samplesX.size());
+    mapSamplesToTiles(samplesX, samplesY, tileIndices);
 
-    //std::cout << "Discrepancy: " << numSamples << " Samples; " << numSquares << " Tiles" << '\n';
-
-    //timing
-    std::clock_t start;
-    double duration;
-
-    start = std::clock();
-
-    //Step 1: Count how many elements belong to each tile
-    for (std::size_t i = 0; i < numSamples; i++) {
-
-        float sampleX = samplesX[i];
-        float sampleY = samplesY[i];
+    return calculateTileDiscrepancies(samplesX, samplesY, tileIndices, tile->numTiles);
+}
 
-        pointsInTilesCount[tile->mapPointToTile1D(vec2(sampleX, sampleY))]++;
+//PRECONDITION: tile != nullptr
+void TileRenderer::mapSamplesToTiles(std::span<const float> samplesX, std::span<const float> samplesY,
+                                     std::span<int> tileIndices) {
+    // every thread maps a contiguous block of samples with a single call into the tile
+    const auto blockCount = static_cast<std::int64_t>((tileIndices.size() + tileMappingBlockSize - 1) / tileMappingBlockSize);
+#pragma omp parallel for schedule(static)
+    for (std::int64_t b = 0; b < blockCount; b++) {
+        const auto first = static_cast<std::size_t>(b) * tileMappingBlockSize;
+        const auto count = std::min(tileMappingBlockSize, tileIndices.size() - first);
+        tile->mapPointsToTiles1D(samplesX.subspan(first, count), samplesY.subspan(first, count),
+                                 tileIndices.subspan(first, count));
     }
+}
 
-    duration = (std::clock() - start) / (double) CLOCKS_PER_SEC;
-    //std::cout << "Step1: " << duration << '\n';
-
-    start = clock();
-
-    //Step 2: calc prefix Sum
-    std::vector<float> pointsInTilesPrefixSum(pointsInTilesCount);
-    int prefixSum = 0;
-    int sampleCount = 0;
-    int maxSampleCount = 0;
-    for (std::size_t i = 0; i < static_cast<std::size_t>(tile->numTiles); i++) {
-        sampleCount = static_cast<int>(pointsInTilesPrefixSum[i]);
-        pointsInTilesPrefixSum[i] = static_cast<float>(prefixSum);
-        prefixSum += sampleCount;
-        maxSampleCount = max(maxSampleCount, sampleCount);
+#ifdef TILE_ACCUMULATION_CHECK
+//PRECONDITION: tile != nullptr, all points are accumulated
+void TileRenderer::verifyTileAccumulation() {
+    const auto *table = viewer()->scene()->table();
+    const auto start = std::chrono::steady_clock::now();
+    const auto cpuAccumulation = tile->accumulatePoints(table->activeXColumn(), table->activeYColumn());
+    const auto duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // red channel of the accumulate texture, the tiles are stored one row after the other like on the CPU
+    const auto image = m_tileAccumulateTexture->getImage(0, GL_RED, GL_FLOAT);
+    std::vector<float> gpuCounts(image.size() / sizeof(float));
+    std::memcpy(gpuCounts.data(), image.data(), gpuCounts.size() * sizeof(float));
+
+    if (gpuCounts.size() != cpuAccumulation.counts.size()) {
+        std::cout << std::format("Accumulation size mismatch: GPU {} tiles, CPU {} tiles", gpuCounts.size(),
+                                 cpuAccumulation.counts.size()) << std::endl;
+        return;
     }
 
-    duration = (std::clock() - start) / (double) CLOCKS_PER_SEC;
-    //std::cout << "Step2: " << duration << '\n';
-
-    start = clock();
-
-    //Step 3: sort points according to tile
-    // 1D array with "buckets" according to prefix Sum of tile
-    // also set the bounding box of points inside tile
-    std::vector<float> pointsInTilesRunningPrefixSum(pointsInTilesPrefixSum);
-    for (std::size_t i = 0; i < numSamples; i++) {
-
-        float sampleX = samplesX[i];
-        float sampleY = samplesY[i];
-
-        int squareIndex1D = tile->mapPointToTile1D(vec2(sampleX, sampleY));
-
-        // put sample in correct position and increment prefix sum
-        int sampleIndex = static_cast<int>(pointsInTilesRunningPrefixSum[squareIndex1D]++);
-        sortedX[sampleIndex] = sampleX;
-        sortedY[sampleIndex] = sampleY;
-
-        //set bounding box of samples inside tile
-        tilesMaxBoundX[squareIndex1D] = max(tilesMaxBoundX[squareIndex1D], sampleX);
-        tilesMaxBoundY[squareIndex1D] = max(tilesMaxBoundY[squareIndex1D], sampleY);
-
-        tilesMinBoundX[squareIndex1D] = min(tilesMinBoundX[squareIndex1D], sampleX);
-        tilesMinBoundY[squareIndex1D] = min(tilesMinBoundY[squareIndex1D], sampleY);
+    std::size_t mismatches = 0;
+    float gpuMax = 0.0f;
+    for (std::size_t i = 0; i < gpuCounts.size(); i++) {
+        mismatches += gpuCounts[i] != cpuAccumulation.counts[i] ? 1 : 0;
+        gpuMax = max(gpuMax, gpuCounts[i]);
     }
 
-    duration = (std::clock() - start) / (double) CLOCKS_PER_SEC;
-    //std::cout << "Step3: " << duration << '\n';
-
-    start = clock();
-
-    //Step 4: calculate discrepancy for each tile
-    // this is done using a parallel for loop with the OpenMP Framework - need to compile with OpenMP support (add in CMakeList)
-    // the computations of the discrpeancy of each seperate tile is independent
-    // the number of threads used can be set to how many cores the respective PC has
-    omp_set_num_threads(4);
-#pragma omp parallel
-    {
-        /*
-#pragma omp master
-        {
-            std::cout << "NumThreads: " << omp_get_num_threads() << '\n';
-        }
-#pragma omp barrier
-
-        std::cout << "Thread: " << omp_get_thread_num() << '\n';
-#pragma omp barrier
-*/
-
-#pragma omp for
-        for (int i = 0; i < tile->numTiles; i++) {
-
-            float maxDifference = 0.0f;
-            const int startPoint = static_cast<int>(pointsInTilesPrefixSum[i]);
-            const int stopPoint = static_cast<int>(pointsInTilesPrefixSum[i] + pointsInTilesCount[i]);
-
-            //use the addition and not PrefixSum[i+1] so we can easily get the last boundary
-            for (int j = startPoint; j < stopPoint; j++) {
-                //normalize sample inside its tile
-                float stopValueXNorm = mapInterval(sortedX[j], tilesMinBoundX[i], tilesMaxBoundX[i], 1);
-                float stopValueYNorm = mapInterval(sortedY[j], tilesMinBoundY[i], tilesMaxBoundY[i], 1);
-
-                // calculate area
-                float area = stopValueXNorm * stopValueYNorm;
-
-                // closed interval [startValue, stopValue]
-                float countInside = 0.0f;
-                for (int k = startPoint; k < stopPoint; k++) {
-                    //normalize sample inside its square
-                    float sampleXNorm = mapInterval(sortedX[k], tilesMinBoundX[i], tilesMaxBoundX[i], 1);
-                    float sampleYNorm = mapInterval(sortedY[k], tilesMinBoundY[i], tilesMaxBoundY[i], 1);
-
-
-                    if (sampleXNorm <= stopValueXNorm &&
-                        sampleYNorm <= stopValueYNorm) {
-                        countInside++;
-                    }
-                }
-                float density = countInside / float(pointsInTilesCount[i]);
-                float difference = std::abs(density - area);
-
-                if (difference > maxDifference) {
-                    maxDifference = difference;
-                }
-            }
-
-            maxDifference = max(eps, maxDifference);
-
-            // Ease In
-            maxDifference = pow(maxDifference, m_discrepancy_easeIn);
-
-            // account for tiles with few points
-            //maxDifference = (1 - m_discrepancy_lowCount) * maxDifference + m_discrepancy_lowCount * (1 - pow((pointsInTilesCount[i] / float(maxSampleCount)), 2));
-            maxDifference = min(maxDifference + m_discrepancy_lowCount *
-                                                (1 - pow((pointsInTilesCount[i] / float(maxSampleCount)), 2.f)), 1.0f);
-
+    std::cout << std::format("Accumulation of {} tiles: {} mismatching tiles, max GPU {} / CPU {}, CPU took {:.2f} ms",
+                             gpuCounts.size(), mismatches, gpuMax, cpuAccumulation.maxCount, duration) << std::endl;
+}
+#endif
 
-            discrepancies[i] = maxDifference;
-        }
+//PRECONDITION: tile != nullptr
+const TileDiscrepancies &TileRenderer::cachedDiscrepancy2D() {
+    const auto *table = viewer()->scene()->table();
+
+    const DiscrepancyCacheKey key{m_selected_tile_style, tile->tileSizeWS, ivec2(tile->m_tile_cols, tile->m_tile_rows),
+                                  tile->minBounds_Offset, tile->maxBounds_Offset, table->minimumBounds(),
+                                  table->maximumBounds(), table->activeRowCount()};
+
+    const auto cached = std::find_if(m_discrepancyCache.begin(), m_discrepancyCache.end(),
+                                     [&key](const auto &entry) { return entry.first == key; });
+    if (cached != m_discrepancyCache.end()) {
+        std::rotate(m_discrepancyCache.begin(), cached, std::next(cached));
+        return m_discrepancyCache.front().second;
     }
 
-    duration = (std::clock() - start) / (double) CLOCKS_PER_SEC;
-    //std::cout << "Step4: " << duration << '\n' << '\n';
+    if (m_discrepancyCache.size() >= discrepancyCacheSize)
+        m_discrepancyCache.pop_back();
 
-    return discrepancies;
+    m_discrepancyCache.emplace_front(key, calculateDiscrepancy2D(table->activeXColumn(), table->activeYColumn(),
+                                                                 table->maximumBounds(), table->minimumBounds()));
+    return m_discrepancyCache.front().second;
 }
 
 GLubyte f2b(auto f) {
@@ -1410,9 +1362,7 @@ void generate_normals_from_heightmap(std::vector<GLubyte> &img, unsigned int wid
 }
 
 void TileRenderer::fileLoaded(const std::string &filename) {
-    using namespace std::filesystem;
-    const path filepath{filename};
-    m_debug_heightmap = filepath.extension() != path{".csv"};
+    m_debug_heightmap = !Table::isTableFile(filename);
     viewer()->BROADCAST(&TileRenderer::m_debug_heightmap);
     if (m_debug_heightmap) {
         unsigned int width, height;
@@ -1453,15 +1403,7 @@ void TileRenderer::fileLoaded(const std::string &filename) {
             }
         }
     } else {
-        // reset column names
-        m_guiColumnNames = "None";
-        m_guiColumnNames += '\0'; /// Trailing null-terminators in string literals apparently gets truncated by STL
-
-        // extract column names and prepare GUI
-        std::vector<std::string> tempNames = viewer()->scene()->table()->getColumnNames();
-
-        for (const auto &tempName: tempNames)
-            m_guiColumnNames += tempName + '\0';
+        updateColumnNames();
 
         m_currentFileName = filename;
 
@@ -1481,16 +1423,55 @@ void TileRenderer::fileLoaded(const std::string &filename) {
     viewer()->forceOffloadRender();
 }
 
+void TileRenderer::updateColumnNames() {
+    // reset column names
+    m_guiColumnNames = "None";
+    m_guiColumnNames += '\0'; /// Trailing null-terminators in string literals apparently gets truncated by STL
+
+    // extract column names and prepare GUI
+    std::vector<std::string> tempNames = viewer()->scene()->table()->getColumnNames();
+
+    for (const auto &tempName: tempNames)
+        m_guiColumnNames += tempName + '\0';
+}
+
+void TileRenderer::keepColumnSelection(const std::vector<std::string> &previousColumnNames) {
+    // columns that turned out to be non-numeric were dropped, the selection keeps the others by name
+    const auto columnNames = viewer()->scene()->table()->getColumnNames();
+    for (auto *id: {&m_xAxisDataID, &m_yAxisDataID, &m_radiusDataID, &m_colorDataID}) {
+        if (*id <= 0 || *id > static_cast<int>(previousColumnNames.size()))
+            continue;
+        const auto it = std::find(columnNames.begin(), columnNames.end(), previousColumnNames[*id - 1]);
+        *id = it == columnNames.end() ? 0 : static_cast<int>(it - columnNames.begin()) + 1;
+    }
+}
+
 void TileRenderer::updateData() {
     // update buffers according to recent changes -> since combo also contains 'None" we need to subtract 1 from ID
-    viewer()->scene()->table()->updateBuffers(m_xAxisDataID - 1, m_yAxisDataID - 1, m_radiusDataID - 1,
-                                              m_colorDataID - 1);
+    const auto previousColumnNames = viewer()->scene()->table()->getColumnNames();
+    if (!viewer()->scene()->table()->updateBuffers(m_xAxisDataID - 1, m_yAxisDataID - 1, m_radiusDataID - 1,
+                                                   m_colorDataID - 1)) {
+        // a selected column of a lazily parsed file was not numeric after all
+        keepColumnSelection(previousColumnNames);
+        updateColumnNames();
+    }
 
     // update VBOs for all four columns
-    m_xColumnBuffer->setData(viewer()->scene()->table()->activeXColumn(), GL_STATIC_DRAW);
-    m_yColumnBuffer->setData(viewer()->scene()->table()->activeYColumn(), GL_STATIC_DRAW);
-    m_radiusColumnBuffer->setData(viewer()->scene()->table()->activeRadiusColumn(), GL_STATIC_DRAW);
-    m_colorColumnBuffer->setData(viewer()->scene()->table()->activeColorColumn(), GL_STATIC_DRAW);
+    // the buffers are allocated for the final row count, so rows that are still streamed in can be appended later
+    const auto *table = viewer()->scene()->table();
+    const auto capacity = static_cast<GLsizeiptr>(table->expectedRowCount() * sizeof(float));
+    const auto usage = table->isStreaming() ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
+    const auto uploadColumn = [&](const std::unique_ptr<Buffer> &buffer, std::span<const float> column) {
+        buffer->setData(capacity, nullptr, usage);
+        if (!column.empty())
+            buffer->setSubData(0, static_cast<GLsizeiptr>(column.size_bytes()), column.data());
+    };
+    uploadColumn(m_xColumnBuffer, table->activeXColumn());
+    uploadColumn(m_yColumnBuffer, table->activeYColumn());
+    uploadColumn(m_radiusColumnBuffer, table->activeRadiusColumn());
+    uploadColumn(m_colorColumnBuffer, table->activeColorColumn());
+    m_accumulatedVertexCount = 0;
+    m_discrepancyCache.clear();
 
 
     // update VAO for all buffers ----------------------------------------------------
@@ -1508,10 +1489,25 @@ void TileRenderer::updateData() {
 
     // -------------------------------------------------------------------------------
 
+    updateModelTransform();
+
+    // calculate accumulate texture settings - needs to be last step here ------------------------------
+    calculateTileTextureSize(inverse(viewer()->modelViewProjectionTransform()));
+    // -------------------------------------------------------------------------------
+
+    m_tileNormalsBuffer.reset();
+}
+
+void TileRenderer::updateModelTransform() {
     // Scaling the model's bounding box to the canonical view volume
     vec3 boundingBoxSize =
             viewer()->scene()->table()->maximumBounds() - viewer()->scene()->table()->minimumBounds();
     float maximumSize = std::max({boundingBoxSize.x, boundingBoxSize.y, boundingBoxSize.z});
+
+    // no rows yet (e.g. the first chunk of a streamed table has not arrived)
+    if (maximumSize <= 0.0f)
+        return;
+
     mat4 modelTransform = scale(vec3(2.0f) / vec3(maximumSize));
     modelTransform = modelTransform * translate(-0.5f * (viewer()->scene()->table()->minimumBounds() +
                                                          viewer()->scene()->table()->maximumBounds()));
@@ -1519,25 +1515,64 @@ void TileRenderer::updateData() {
 
     // store diameter of current scatter plot and initialize light position
     viewer()->m_scatterPlotDiameter = sqrt(pow(boundingBoxSize.x, 2.f) + pow(boundingBoxSize.y, 2.f));
+    resetLightTransform();
+}
 
-    // initial position of the light source (azimuth 120 degrees, elevation 45 degrees, 5 times the distance to the object in center) ---------------------------------------------------------
-    glm::mat4 viewTransform = viewer()->viewTransform();
-    glm::vec3 initLightDir = normalize(
-            glm::rotate(glm::mat4(1.0f), glm::radians(45.0f), glm::vec3(1.0f, 0.0f, 0.0f)) *
-            glm::rotate(glm::mat4(1.0f), glm::radians(120.0f), glm::vec3(0.0f, 0.0f, 1.0f)) *
-            glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
-    glm::mat4 newLightTransform = glm::inverse(viewTransform) * glm::translate(mat4(1.0f), (5 *
-                                                                                            viewer()->m_scatterPlotDiameter *
-                                                                                            initLightDir)) *
-                                  viewTransform;
-    viewer()->setLightTransform(newLightTransform);
-    //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+void TileRenderer::appendStreamedRows() {
+    auto *table = viewer()->scene()->table();
+    if (!table->isStreaming() || m_debug_heightmap)
+        return;
 
-    // calculate accumulate texture settings - needs to be last step here ------------------------------
-    calculateTileTextureSize(inverse(viewer()->modelViewProjectionTransform()));
-    // -------------------------------------------------------------------------------
+    const auto previousMinBounds = table->minimumBounds();
+    const auto previousMaxBounds = table->maximumBounds();
 
-    m_tileNormalsBuffer.reset();
+    const auto previousColumnNames = table->getColumnNames();
+    const auto rows = table->pollStream();
+    const bool finished = !table->isStreaming();
+    if (rows.count == 0 && !finished && !rows.columnsChanged)
+        return;
+
+    if (rows.columnsChanged) {
+        if (rows.first == 0) {
+            // the first chunk replaced the header columns with the numeric ones, so the default selection is made again
+            m_xAxisDataID = 1;
+            m_yAxisDataID = 2;
+            m_radiusDataID = 3;
+            m_colorDataID = 4;
+        } else {
+            keepColumnSelection(previousColumnNames);
+        }
+        updateColumnNames();
+
+        // the buffers are allocated for the row count and the active columns may have changed, so every row read so
+        // far is uploaded again
+        updateData();
+        m_normals_parameters_changed = true;
+        viewer()->forceOffloadRender();
+        return;
+    }
+
+    // append new rows into the pre-grown buffers
+    const auto appendColumn = [&rows](const std::unique_ptr<Buffer> &buffer, std::span<const float> column) {
+        if (rows.first + rows.count <= column.size())
+            buffer->setSubData(static_cast<GLintptr>(rows.first * sizeof(float)),
+                               static_cast<GLsizeiptr>(rows.count * sizeof(float)), column.data() + rows.first);
+    };
+    appendColumn(m_xColumnBuffer, table->activeXColumn());
+    appendColumn(m_yColumnBuffer, table->activeYColumn());
+    appendColumn(m_radiusColumnBuffer, table->activeRadiusColumn());
+    appendColumn(m_colorColumnBuffer, table->activeColorColumn());
+
+    // the tile grid only has to be rebuilt if the new rows grew the bounds, otherwise only the new rows are accumulated
+    const bool boundsChanged =
+            table->minimumBounds() != previousMinBounds || table->maximumBounds() != previousMaxBounds;
+    if (boundsChanged)
+        updateModelTransform();
+    if (boundsChanged || (finished && m_renderDiscrepancy))
+        calculateTileTextureSize(inverse(viewer()->modelViewProjectionTransform()));
+
+    m_normals_parameters_changed = true;
+    viewer()->forceOffloadRender();
 }
 
 bool TileRenderer::offscreen_render() {
@@ -1584,25 +1619,26 @@ bool TileRenderer::offscreen_render() {
             const auto memPtr = reinterpret_cast<glm::vec4 *>(frame_data.transfer_buffer->mapRange(0, vCount *
                                                                                                       static_cast<GLsizeiptr>(sizeof(glm::vec4)),
                                                                                                    GL_MAP_READ_BIT));
-            std::vector<glm::vec4> data{};
-            if (memPtr != nullptr) {
-                data = {memPtr, memPtr + vCount};
-            }
+            // Copied straight into level 0 of the pyramid, which is allocated for all levels at once
+            MipPyramid pyramid{glm::uvec2{frame_data.size},
+                               memPtr != nullptr ? std::span<const glm::vec4>{memPtr, static_cast<std::size_t>(vCount)}
+                                                 : std::span<const glm::vec4>{}};
             if (!frame_data.transfer_buffer->unmap())
                 throw std::runtime_error{"Failed to unmap GPU buffer! (m_normal_transfer_buffer)"};
             frame_data.transfer_buffer->unbind(GL_PIXEL_PACK_BUFFER);
 
-            // According to https://en.cppreference.com/w/cpp/thread/future/~future we don't have to explicitly wait for
-            // std::async to complete as the future destructor will automatically wait (std::async is magic)
-            frame_data.tile_normal_async_task = std::async(std::launch::async,
-                                                           [&channel = this->m_normal_tex_channel,
-                                                                   size = frame_data.size,
-                                                                   data = std::move(data)]() mutable {
-                                                               auto levels = HapticInteractor::generateMipmaps(
-                                                                       glm::uvec2{size}, std::move(data));
-                                                               channel.write(levels);
-                                                               return std::move(levels);
-                                                           });
+            // Thread pool futures don't wait for their job when destroyed, so wait for a job of this frame data that
+            // might still be running (e.g. if it was reset) before starting a new one, else it could overwrite the
+            // newer mip-maps in the buffer
+            if (frame_data.tile_normal_async_task.valid())
+                frame_data.tile_normal_async_task.wait();
+            // The conversion for sampling happens here as well, so the haptic loop only has to swap buffers
+            frame_data.tile_normal_async_task = ThreadPool::global().submit(
+                    [&buffer = *this->m_normal_tex_buffer, pyramid = std::move(pyramid)]() mutable {
+                        pyramid.generate();
+                        buffer.write([&pyramid](SampledMipPyramid &mip_maps) { mip_maps.assign(pyramid); });
+                        return std::move(pyramid);
+                    });
 
             // Finish by releasing buffers:
             frame_data.pass_sync = {};
@@ -1618,9 +1654,9 @@ bool TileRenderer::offscreen_render() {
             const auto levels = frame_data.tile_normal_async_task.get();
             // Manually set mipmap levels
             BindGuard _g{frame_data.texture};
-            for (GLint i = 0; i < levels.size(); ++i)
-                frame_data.texture->image2D(i, GL_RGBA32F, levels.at(i).first, 0, GL_RGBA, GL_FLOAT,
-                                            levels.at(i).second.data());
+            for (GLint i = 0; i < static_cast<GLint>(MipPyramid::LevelCount); ++i)
+                frame_data.texture->image2D(i, GL_RGBA32F, levels.dims(i), 0, GL_RGBA, GL_FLOAT,
+                                            levels.level(i).data());
 
             viewer()->m_sharedResources.smoothNormalsTexture = frame_data.texture;
             ++frame_data.step;
@@ -1634,3 +1670,10 @@ bool TileRenderer::offscreen_render() {
 }
 
 TileRenderer::TileRenderer() = default;
+
+TileRenderer::~TileRenderer() {
+    // The mip-map jobs write to m_normal_tex_buffer, so they have to be done before it's released
+    for (auto &frame_data: m_normal_frame_data)
+        if (frame_data.tile_normal_async_task.valid())
+            frame_data.tile_normal_async_task.wait();
+}
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <deque>
 #include <future>
+#include <span>
 
 #include "../Renderer.h"
-#include "../../Channel.h"
 #include "../../Constants.h"
+#include "../../MipPyramid.h"
+#include "../../TextureSampler.h"
+#include "../../TripleBuffer.h"
+#include "Discrepancy.h"
 
 #include <glm/glm.hpp>
 
@@ -30,8 +35,9 @@ namespace molumes {
     class TileRenderer : public Renderer {
     public:
         TileRenderer();
-        explicit TileRenderer(Viewer *viewer,
-                              WriterChannel<std::array<std::pair<glm::uvec2, std::vector<glm::vec4>>, HapticMipMapLevels>> &&normal_channel);
+        explicit TileRenderer(Viewer *viewer, std::shared_ptr<TripleBuffer<SampledMipPyramid>> normal_tex_buffer);
+
+        ~TileRenderer() override;
 
         void setEnabled(bool enabled) override;
 
@@ -53,11 +59,17 @@ namespace molumes {
         std::unique_ptr<globjects::Buffer> m_radiusColumnBuffer = std::make_unique<globjects::Buffer>();
         std::unique_ptr<globjects::Buffer> m_colorColumnBuffer = std::make_unique<globjects::Buffer>();
 
+        // number of points already accumulated into m_tileAccumulateTexture (points are accumulated incrementally)
+        int m_accumulatedVertexCount = 0;
+
 
         // TILES GRID VERTEX DATA------------------------------------------------------------
         std::unique_ptr<globjects::VertexArray> m_vaoTiles = std::make_unique<globjects::VertexArray>();
         std::unique_ptr<globjects::Buffer> m_verticesTiles = std::make_unique<globjects::Buffer>();
+        // raw maximum difference and point count of every tile, the transfer function is applied in the shader
         std::unique_ptr<globjects::Buffer> m_discrepanciesBuffer = std::make_unique<globjects::Buffer>();
+        std::unique_ptr<globjects::Buffer> m_tilePointCountsBuffer = std::make_unique<globjects::Buffer>();
+        unsigned int m_maxTilePointCount = 0;
 
 
         // QUAD VERTEX DATA -------------------------------------------------------------------------------
@@ -157,6 +169,17 @@ namespace molumes {
 
         void updateData();
 
+        void updateModelTransform();
+
+        // uploads rows the table read in the background since the last frame
+        void appendStreamedRows();
+
+        // fills the column combo items with the column names of the table
+        void updateColumnNames();
+
+        // moves the selected columns to where the table has them now that some of its columns were dropped
+        void keepColumnSelection(const std::vector<std::string> &previousColumnNames);
+
         // items for ImGui Combo
         std::string m_currentFileName = "None";
 
@@ -202,10 +225,8 @@ namespace molumes {
         float m_discrepancyDiv = 1.0f;
         // ease function modyfier adjustable by user
         float m_discrepancy_easeIn = 1.0f;
-        float m_discrepancy_easeIn_tmp = m_discrepancy_easeIn;
         // adjustment rate for tiles with few points adjustable by user
         float m_discrepancy_lowCount = 0.0f;
-        float m_discrepancy_lowCount_tmp = m_discrepancy_lowCount;
 
         //regression parameters
         // sigma of gauss kernel for KDE adjustable by user
@@ -258,12 +279,43 @@ namespace molumes {
 
         // DISCREPANCY------------------------------------------------------------------------------
 
-        std::vector<float>
-        calculateDiscrepancy2D(const std::vector<float> &samplesX, const std::vector<float> &samplesY,
+        TileDiscrepancies
+        calculateDiscrepancy2D(std::span<const float> samplesX, std::span<const float> samplesY,
                                glm::vec3 maxBounds, glm::vec3 minBounds);
 
+        // maps the samples to the tiles of the current grid in parallel blocks
+        void mapSamplesToTiles(std::span<const float> samplesX, std::span<const float> samplesY,
+                               std::span<int> tileIndices);
+        static constexpr std::size_t tileMappingBlockSize = 1 << 16;
+
+#ifdef TILE_ACCUMULATION_CHECK
+        // compares the accumulate texture with the tile accumulation computed on the CPU, results go to stdout
+        void verifyTileAccumulation();
+#endif
+
+        // returns the discrepancies of the current tile grid, only calculated if the grid or the data changed
+        const TileDiscrepancies &cachedDiscrepancy2D();
+
+        // everything the per tile discrepancy sweep depends on, besides the data columns themselves
+        struct DiscrepancyCacheKey {
+            int tileStyle = 0;
+            float tileSizeWS = 0.0f;
+            glm::ivec2 gridSize = glm::ivec2(0);
+            glm::vec2 gridMinBounds = glm::vec2(0.0f);
+            glm::vec2 gridMaxBounds = glm::vec2(0.0f);
+            glm::vec3 dataMinBounds = glm::vec3(0.0f);
+            glm::vec3 dataMaxBounds = glm::vec3(0.0f);
+            std::size_t rowCount = 0;
+
+            bool operator==(const DiscrepancyCacheKey &) const = default;
+        };
+
+        // most recently used discrepancies first, cleared whenever the data columns change
+        static constexpr std::size_t discrepancyCacheSize = 4;
+        std::deque<std::pair<DiscrepancyCacheKey, TileDiscrepancies>> m_discrepancyCache;
+
 
-        using NormalTexType = std::array<std::pair<glm::uvec2, std::vector<glm::vec4>>, HapticMipMapLevels>;
+        using NormalTexType = MipPyramid;
         struct NormalFrameData {
             std::shared_ptr<globjects::Texture> texture{};
             std::unique_ptr<globjects::Buffer> transfer_buffer{};
@@ -278,7 +330,8 @@ namespace molumes {
 
     public:
 
-        WriterChannel<NormalTexType> m_normal_tex_channel;
+        // The mip-map jobs convert the pyramids for sampling into this buffer, which the haptic loop reads from
+        std::shared_ptr<TripleBuffer<SampledMipPyramid>> m_normal_tex_buffer;
 
         bool updateColorMap();
         bool m_debug_heightmap{false};